@@ -9,12 +9,28 @@
 #include "def.h"
 #include "config.h"
 
+#include "ring.h"
+
 #define BUTTON_COUNT 6
-#define BUTTON_STATE_PRESSED 0x8000
-#define BUTTON_TIMER_MASK 0x7FFF
 
-// Re-enable trigger after 100 ms = 2 * 50 ms
-#define BUTTON_WAIT_TIME 2
+// Number of events queued for buttons_process (Power of two). Events which
+// don't fit are delayed until the main loop took the queued ones.
+#define BUTTON_EVENT_BUFFER_SIZE 4
+
+// Types of the button events
+#define BUTTON_PRESS 0x00
+#define BUTTON_RELEASE 0x01
+#define BUTTON_LONG_PRESS 0x02 // Held down for BUTTON_LONG_PRESS_TIME
+#define BUTTON_REPEAT 0x03 // Held down with auto-repeat (buttons_set_repeat)
+
+// Value of buttons_t.hold while no button is held down
+#define BUTTON_NONE 0xFF
+
+// Buttons the current view listens to (see buttons_set_mask)
+#define BUTTON_MASK(button) (1 << (button))
+#define BUTTON_MASK_SHIFT_REGISTER 0x0F // PB1 to PB4 (Polled)
+#define BUTTON_MASK_PORT 0x30 // PB5 and PB6 (Port interrupts)
+#define BUTTON_MASK_ALL 0x3F
 
 typedef enum {
   BUTTON_1 = 0x00,
@@ -25,17 +41,53 @@ typedef enum {
   BUTTON_6 = 0x05
 } button_t;
 
+/**
+ * An input event of a button with the time of the shared clock (see
+ * timer_get_time).
+ */
+typedef struct {
+  uint8_t type;
+  uint8_t button; // button_t
+  uint16_t time;
+} button_event_t;
+
 typedef struct {
-  uint16_t state[BUTTON_COUNT];
+  // Debounced state of the buttons (BUTTON_MASK, set while pressed)
+  uint8_t pressed;
 
-  bool_t (*callback)(button_t);
+  // 2-bit vertical counters of the samples which differ from the debounced
+  // state (Bit n of both bytes forms the counter of button n)
+  uint8_t count0;
+  uint8_t count1;
+
+  // Events queued by the interrupts (Indices like ring_t)
+  button_event_t events[BUTTON_EVENT_BUFFER_SIZE];
+  volatile uint8_t e_head;
+  volatile uint8_t e_tail;
+
+  // Buttons which are sampled and reported (BUTTON_MASK)
+  uint8_t mask;
+
+  // Buttons which repeat while held down (BUTTON_MASK)
+  uint8_t repeat;
+
+  // The button pressed last while it is held down with the time of the press
+  // and of its next repeat
+  uint8_t hold;
+  bool_t hold_long;
+  uint16_t hold_time;
+  uint16_t hold_repeat;
+
+  bool_t (*callback)(const button_event_t *event);
 } buttons_t;
 
 /**
  * Initializes the data structure to hold all button presses
  * and enables the necessary interrupts.
- * This implementation uses TIMER_2 and polling to retrieve the button
- * state.
+ * PB5 and PB6 wake the CPU with port interrupts and are only polled with the
+ * timer TIMER_BUTTONS while a button is down or debounced. The buttons on the
+ * shift register have no wake source, so they are polled as long as they are
+ * part of the mask.
  *
  * @param buttons The data structure to use
  */
@@ -43,12 +95,50 @@ void
 buttons_init (buttons_t *buttons);
 
 /**
- * Sets the callback which gets notified if a button gets pressed.
- * The parameter passed to the callback is the number of pressed button.
+ * Sets the callback which gets the queued events passed by buttons_process.
+ * Besides presses and releases the button pressed last creates a long press
+ * event and, if selected with buttons_set_repeat, repeat events after the
+ * delay BUTTON_REPEAT_DELAY in the period BUTTON_REPEAT_PERIOD.
  *
  * @param callback The callback to execute
  */
 void
-buttons_set_callback (bool_t (*callback)(button_t));
+buttons_set_callback (bool_t (*callback)(const button_event_t *event));
+
+/**
+ * Selects the buttons which are sampled and reported to the callback.
+ * Views without the shift register buttons need no wake ups while no button
+ * is pressed.
+ *
+ * @param mask The buttons to listen to (BUTTON_MASK)
+ */
+void
+buttons_set_mask (uint8_t mask);
+
+/**
+ * Selects the buttons which create repeat events while held down.
+ *
+ * @param mask The buttons which repeat (BUTTON_MASK)
+ */
+void
+buttons_set_repeat (uint8_t mask);
+
+/**
+ * Passes the queued button events to the callback.
+ * Call this from the main loop after the CPU was woken up.
+ *
+ * @return true if one of the callbacks returned true
+ */
+bool_t
+buttons_process (void);
+
+/**
+ * Returns if button events are waiting for buttons_process.
+ * Call this with disabled interrupts before entering low power mode.
+ *
+ * @return true if button presses are queued
+ */
+bool_t
+buttons_check_pending (void);
 
 #endif // !__BUTTONS_H
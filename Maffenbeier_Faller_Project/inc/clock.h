@@ -0,0 +1,77 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#ifndef __CLOCK_H
+#define __CLOCK_H
+
+#include <stdint.h>
+
+#include "def.h"
+#include "config.h"
+
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+// Calibrated DCO frequencies. MCLK and SMCLK run at the DCO frequency.
+#define CLOCK_1MHZ 0x00
+#define CLOCK_8MHZ 0x01
+#define CLOCK_16MHZ 0x02 // Requires a supply voltage of at least 3.3 V
+#define CLOCK_PROFILE_COUNT 3
+
+#define CLOCK_1MHZ_FREQUENCY 1000000UL
+#define CLOCK_8MHZ_FREQUENCY 8000000UL
+#define CLOCK_16MHZ_FREQUENCY 16000000UL
+
+// Frequency of SMCLK with the profile selected at boot (Hz)
+#if CLOCK_PROFILE == CLOCK_1MHZ
+#define F_SMCLK CLOCK_1MHZ_FREQUENCY
+#elif CLOCK_PROFILE == CLOCK_8MHZ
+#define F_SMCLK CLOCK_8MHZ_FREQUENCY
+#elif CLOCK_PROFILE == CLOCK_16MHZ
+#define F_SMCLK CLOCK_16MHZ_FREQUENCY
+#else
+#error "Unknown CLOCK_PROFILE"
+#endif
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * One of the CLOCK_*MHZ profiles.
+ */
+typedef uint8_t clock_profile_t;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+/**
+ * Sets up the DCO with the calibration data of the profile.
+ * Has to be called before the UART and the timers are initialized.
+ * Falls back to CLOCK_1MHZ if the profile isn't calibrated (The build checks
+ * that the UART can generate its baud rate with both).
+ *
+ * @param profile The profile to use
+ */
+void
+clock_init (clock_profile_t profile);
+
+/**
+ * Returns the active profile.
+ *
+ * @return The active profile
+ */
+clock_profile_t
+clock_get_profile (void);
+
+/**
+ * Returns the frequency of MCLK and SMCLK.
+ *
+ * @return The frequency in kHz
+ */
+uint16_t
+clock_get_frequency (void);
+
+#endif // !__CLOCK_H
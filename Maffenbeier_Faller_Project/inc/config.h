@@ -10,6 +10,22 @@
 #define TETRIS_HEIGHT 22
 #define TETRIS_TOP_HIDDEN 2
 #define TETRIS_SCALE 1
+
+// Doubles the size of the game screen with DEC double-height lines instead
+// of TETRIS_SCALE. The terminal needs at least 44 rows.
+//#define TETRIS_DEC_SCALE
+
+#ifdef TETRIS_DEC_SCALE
+// Double size lines only have 40 columns and each row uses two lines
+#define TETRIS_X 3
+#define TETRIS_Y 1
+
+#define TETRIS_SCORE_X 18
+#define TETRIS_SCORE_Y 1
+
+#define TETRIS_NEXT_X 18
+#define TETRIS_NEXT_Y 9
+#else
 #define TETRIS_X 10
 #define TETRIS_Y 2
 
@@ -18,6 +34,7 @@
 
 #define TETRIS_NEXT_X 25
 #define TETRIS_NEXT_Y 10
+#endif
 
 #define TETRIS_BORDER_V '|'
 #define TETRIS_BORDER_H '-'
@@ -31,17 +48,59 @@
 #define TETRIS_TETROMINO_L_INV 'O'
 #define TETRIS_TETROMINO_O '$'
 
-#define TETRIS_CMD_BUFFER_SIZE 16
+#define TETRIS_CMD_BUFFER_SIZE 8
+
+// Only send the changed cells of the game field
+#define TETRIS_DELTA_RENDERING
+
+// A new frame is only started if at most this number of bytes of the last
+// frame are waiting in the transmit buffer. Commands received in the meantime
+// are combined into a single frame.
+#define TETRIS_FRAME_BACKLOG 8
+
+// Minimum time between two game frames in milliseconds (Multiple of 10)
+#define TETRIS_FRAME_INTERVAL 30
+
+// DCO frequency (clock_profile_t). The UART divisors, the timer periods and
+// the flash timing are derived from it.
+#define CLOCK_PROFILE CLOCK_1MHZ
 
 #define UART_R_BUFFER_SIZE 8
-#define UART_T_BUFFER_SIZE 56
+#define UART_T_BUFFER_SIZE 64
+
+#define UART_BAUD 115200UL
+
+// Baud rate which can be selected after the connection was established
+// (Press B in the welcome screen). The welcome screen only offers it if the
+// clock can generate it: 230400 requires CLOCK_8MHZ, 460800 CLOCK_16MHZ.
+#define UART_BAUD_FAST 230400UL
+
+// Detect the baud rate of the host: Send a break followed by 'U' (0x55)
+// Switching the baud rate loads the configured rate again, so the host has to
+// repeat the detection after it
+//#define UART_AUTO_BAUD
+
+// Software flow control: XOFF / XON are sent depending on the fill of the
+// receive buffer and the transmission pauses while the host sent XOFF
+//#define UART_FLOW_CONTROL
+
+// The build fails if a bit edge within a character sent with UART_BAUD
+// deviates by more than this value (In 0.1 % of a bit) at CLOCK_PROFILE or
+// the fallback CLOCK_1MHZ. UART_BAUD_FAST is only offered within it.
+#define UART_BAUD_ERROR_MAX 100
+
+// Compress character runs with REP (ESC [ n b) and ECH (ESC [ n X).
+// Disable for terminals which only support the plain VT100 command set.
+#define UART_REPEAT
+#define UART_ERASE
 
-#define UART_1MHZ
-//#define UART_1048KHZ
+// Auto-repeat of held buttons (In ms): Delay after the press and period of
+// the repeat events
+#define BUTTON_REPEAT_DELAY 170
+#define BUTTON_REPEAT_PERIOD 50
 
-#define UART_115K
-//#define UART_38K
-//#define UART_9K
+// Duration until a held button creates a long press event (In ms)
+#define BUTTON_LONG_PRESS_TIME 1000
 
 #define HIGHSCORE_LENGTH 4
 #define HIGHSCORE_NAME_LENGTH 10
@@ -9,6 +9,7 @@
 typedef uint8_t bool_t;
 
 typedef enum {
+  VIEW_WELCOME = 0x00,
   VIEW_GAME = 0x01,
   VIEW_HIGHSCORE = 0x02
 } view_t;
@@ -16,18 +17,6 @@ typedef enum {
 extern view_t view;
 
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
-
-#define KEY_ESCAPE 0x1B
-
-#define KEY_ENTER 0x0D
-#define KEY_SPACE 0x20
-#define KEY_DELETE 0x08
-//#define KEY_DELETE 0x7F
-
-// Prefixed with escape key
-#define KEY_UP 'A'
-#define KEY_DOWN 'B'
-#define KEY_RIGHT 'C'
-#define KEY_LEFT 'D'
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
 #endif // !__DEF_H
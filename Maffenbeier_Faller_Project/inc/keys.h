@@ -0,0 +1,82 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#ifndef __KEYS_H
+#define __KEYS_H
+
+#include <stdint.h>
+
+#include "def.h"
+#include "config.h"
+
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+// No complete key was decoded yet
+#define KEY_NONE 0x00
+
+// Control keys are passed with their ASCII value
+#define KEY_DELETE 0x08 // Backspace (DEL 0x7F is mapped to this key)
+#define KEY_ENTER 0x0D
+#define KEY_ESCAPE 0x1B // Sent if escape is pressed twice
+#define KEY_SPACE 0x20
+
+// Keys decoded from escape sequences
+#define KEY_UP 0x80
+#define KEY_DOWN 0x81
+#define KEY_RIGHT 0x82
+#define KEY_LEFT 0x83
+#define KEY_HOME 0x84
+#define KEY_END 0x85
+#define KEY_INSERT 0x86
+#define KEY_REMOVE 0x87 // Delete key right of the cursor
+#define KEY_PAGE_UP 0x88
+#define KEY_PAGE_DOWN 0x89
+#define KEY_F1 0x8A // Function keys F1 to F12 follow in order
+#define KEY_F12 0x95
+
+// The terminal reported its cursor position (see keys_get_cursor_report)
+#define KEY_CURSOR_REPORT 0x96
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * A key event: A printable ASCII character, a control key or one of the
+ * decoded keys above.
+ */
+typedef uint8_t keycode_t;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+/**
+ * Resets the decoder to wait for the next key.
+ */
+void
+keys_init (void);
+
+/**
+ * Passes the next received character to the decoder.
+ * Each character is processed in constant time so this can be called by the
+ * receive interrupt.
+ *
+ * @param c The received character
+ * @return The completed key or KEY_NONE
+ */
+keycode_t
+keys_decode (uint8_t c);
+
+/**
+ * Returns the position of the last cursor position report.
+ *
+ * @param v Receives the reported row
+ * @param h Receives the reported column
+ */
+void
+keys_get_cursor_report (uint8_t *v, uint8_t *h);
+
+#endif // !__KEYS_H
@@ -4,14 +4,24 @@
 #ifndef __MAIN_H
 #define __MAIN_H
 
-#include "buffer.h"
+#include "ring.h"
 
 /**
  * Prints a welcome message to the console after initializing it.
  */
-static bool_t
+static void
 main_send_welcome (void);
 
+/**
+ * Callback of TIMER_WELCOME which requests the next welcome message.
+ * The message is sent by the main loop, which is the only producer of the
+ * transmit buffer.
+ *
+ * @return true to wake up the CPU
+ */
+static bool_t
+main_on_welcome_timer (void);
+
 /**
  * Displays the main game and exits the welcome screen.
  */
@@ -24,24 +34,31 @@ main_view_game (void);
 static void
 main_view_highscore (void);
 
+/**
+ * Announces the fast baud rate and switches to it. The host has to change
+ * its baud rate as well. Does nothing if the clock can't generate the fast
+ * baud rate, the welcome screen doesn't offer it then.
+ */
+static void
+main_switch_baud (void);
+
 /**
  * Callback which gets called if UART data was received in the welcome
  * screen.
- * Returns true if the CPU is resumed.
  *
  * @param buffer The buffer with the received data
- * @return true if the CPU should be resumed
+ * @return true if the view changed
  */
 static bool_t
-main_uart_received (buffer_t *buffer);
+main_uart_received (ring_t *buffer);
 
 /**
- * Callback when a button gets pressed in the welcome screen.
+ * Callback for the button events in the welcome screen.
  *
- * @param button The button which was pressed
- * @return true if the CPU should be resumed
+ * @param event The button event
+ * @return true if the view changed
  */
 static bool_t
-main_button_pressed (button_t button);
+main_button_pressed (const button_event_t *event);
 
 #endif // !__MAIN_H
@@ -0,0 +1,310 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#ifndef __RING_H
+#define __RING_H
+
+#include <stdint.h>
+
+#include "def.h"
+#include "config.h"
+
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+// The indices run freely over 8 bit so a ring holds at most 128 values
+#define RING_MAX_SIZE 128
+
+// Checks if the size can be used for a ring (Power of two up to 128)
+#define RING_IS_VALID_SIZE(size) \
+  ((size) > 0 && (size) <= RING_MAX_SIZE && ((size) & ((size) - 1)) == 0)
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * A single-producer / single-consumer ring buffer.
+ * The head is only written by the producer and the tail only by the consumer,
+ * so both sides can run in different interrupt levels without locking.
+ */
+typedef struct {
+  uint8_t *buffer;
+  uint8_t mask;
+
+  volatile uint8_t head;
+  volatile uint8_t tail;
+} ring_t;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+/**
+ * Initializes an empty ring buffer.
+ *
+ * @param ring The ring to initialize
+ * @param buffer The memory to store the values in
+ * @param size The size of the memory (see RING_IS_VALID_SIZE)
+ */
+__attribute__((always_inline))
+__inline void
+ring_init (ring_t *ring, uint8_t *buffer, uint8_t size);
+
+/**
+ * Returns 1 if the given ring is full.
+ *
+ * @param ring The ring to check
+ * @return true if the ring is full
+ */
+__attribute__((always_inline))
+__inline bool_t
+ring_is_full (ring_t *ring);
+
+/**
+ * Returns 1 if the given ring is empty.
+ *
+ * @param ring The ring to check
+ * @return true if the ring is empty
+ */
+__attribute__((always_inline))
+__inline bool_t
+ring_is_empty (ring_t *ring);
+
+/**
+ * Returns the number of values in the ring.
+ *
+ * @param ring The ring to use
+ * @return The number of values in the ring
+ */
+__attribute__((always_inline))
+__inline uint8_t
+ring_get_fill (ring_t *ring);
+
+/**
+ * Returns the number of values which can be appended to the ring.
+ *
+ * @param ring The ring to use
+ * @return The number of free entries
+ */
+__attribute__((always_inline))
+__inline uint8_t
+ring_get_free (ring_t *ring);
+
+/**
+ * Appends as many values as fit into the ring.
+ * The values get visible to the consumer at once.
+ * Must only be called by the producer.
+ *
+ * @param ring The ring to use
+ * @param data The values to append
+ * @param length The number of values
+ * @return The number of values which were appended
+ */
+__attribute__((always_inline))
+__inline uint8_t
+ring_write (ring_t *ring, const uint8_t *data, uint8_t length);
+
+/**
+ * Appends the value up to count times as long as it fits into the ring.
+ * The values get visible to the consumer at once.
+ * Must only be called by the producer.
+ *
+ * @param ring The ring to use
+ * @param value The value to append
+ * @param count The number of times to append the value
+ * @return The number of values which were appended
+ */
+__attribute__((always_inline))
+__inline uint8_t
+ring_fill (ring_t *ring, uint8_t value, uint8_t count);
+
+/**
+ * Appends the value to the end of the ring.
+ * Must only be called by the producer if the ring isn't full.
+ *
+ * @param ring The ring to use
+ * @param value The value to append
+ */
+__attribute__((always_inline))
+__inline void
+ring_put (ring_t *ring, uint8_t value);
+
+/**
+ * Removes and returns the first value of the ring.
+ * Must only be called by the consumer if the ring isn't empty.
+ *
+ * @param ring The ring to use
+ * @return The first value of the ring
+ */
+__attribute__((always_inline))
+__inline uint8_t
+ring_get (ring_t *ring);
+
+/**
+ * Returns the value at the index without removing it.
+ * Must only be called by the consumer with an index below the fill size.
+ *
+ * @param ring The ring to use
+ * @param index The index relative to the first value
+ * @return The value at the index
+ */
+__attribute__((always_inline))
+__inline uint8_t
+ring_peek (ring_t *ring, uint8_t index);
+
+/**
+ * Removes the first values of the ring.
+ * Must only be called by the consumer with a count up to the fill size.
+ *
+ * @param ring The ring to use
+ * @param count The number of values to remove
+ */
+__attribute__((always_inline))
+__inline void
+ring_skip (ring_t *ring, uint8_t count);
+
+/**
+ * Removes all values of the ring.
+ * Must only be called by the consumer.
+ *
+ * @param ring The ring to use
+ */
+__attribute__((always_inline))
+__inline void
+ring_clear (ring_t *ring);
+
+// ----------------------------------------------------------------------------
+// Implementations
+// ----------------------------------------------------------------------------
+
+__attribute__((always_inline))
+__inline void
+ring_init (ring_t *ring, uint8_t *buffer, uint8_t size)
+{
+  ring->buffer = buffer;
+  ring->mask = size - 1;
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+__attribute__((always_inline))
+__inline bool_t
+ring_is_full (ring_t *ring)
+{
+  return ((uint8_t) (ring->head - ring->tail) > ring->mask);
+}
+
+__attribute__((always_inline))
+__inline bool_t
+ring_is_empty (ring_t *ring)
+{
+  return (ring->head == ring->tail);
+}
+
+__attribute__((always_inline))
+__inline uint8_t
+ring_get_fill (ring_t *ring)
+{
+  return (uint8_t) (ring->head - ring->tail);
+}
+
+__attribute__((always_inline))
+__inline uint8_t
+ring_get_free (ring_t *ring)
+{
+  return (uint8_t) (ring->mask + 1 - (uint8_t) (ring->head - ring->tail));
+}
+
+__attribute__((always_inline))
+__inline uint8_t
+ring_write (ring_t *ring, const uint8_t *data, uint8_t length)
+{
+  uint8_t head = ring->head;
+  uint8_t free = ring_get_free(ring);
+  if (length > free)
+    length = free;
+
+  // Copy up to the end of the memory and the rest to its start
+  uint8_t index = head & ring->mask;
+  uint8_t first = ring->mask + 1 - index;
+  if (first > length)
+    first = length;
+
+  uint8_t *p = ring->buffer + index;
+  for (uint8_t i = first; i > 0; --i)
+    *p++ = *data++;
+
+  p = ring->buffer;
+  for (uint8_t i = length - first; i > 0; --i)
+    *p++ = *data++;
+
+  // Store the values before they get visible to the consumer
+  ring->head = head + length;
+  return length;
+}
+
+__attribute__((always_inline))
+__inline uint8_t
+ring_fill (ring_t *ring, uint8_t value, uint8_t count)
+{
+  uint8_t head = ring->head;
+  uint8_t free = ring_get_free(ring);
+  if (count > free)
+    count = free;
+
+  for (uint8_t i = 0; i < count; ++i)
+    ring->buffer[(uint8_t) (head + i) & ring->mask] = value;
+
+  // Store the values before they get visible to the consumer
+  ring->head = head + count;
+  return count;
+}
+
+__attribute__((always_inline))
+__inline void
+ring_put (ring_t *ring, uint8_t value)
+{
+  uint8_t head = ring->head;
+
+  // Store the value before it gets visible to the consumer
+  ring->buffer[head & ring->mask] = value;
+  ring->head = head + 1;
+}
+
+__attribute__((always_inline))
+__inline uint8_t
+ring_get (ring_t *ring)
+{
+  uint8_t tail = ring->tail;
+
+  // Read the value before the producer can overwrite it
+  uint8_t value = ring->buffer[tail & ring->mask];
+  ring->tail = tail + 1;
+
+  return value;
+}
+
+__attribute__((always_inline))
+__inline uint8_t
+ring_peek (ring_t *ring, uint8_t index)
+{
+  return ring->buffer[(uint8_t) (ring->tail + index) & ring->mask];
+}
+
+__attribute__((always_inline))
+__inline void
+ring_skip (ring_t *ring, uint8_t count)
+{
+  ring->tail += count;
+}
+
+__attribute__((always_inline))
+__inline void
+ring_clear (ring_t *ring)
+{
+  ring->tail = ring->head;
+}
+
+#endif // !__RING_H
@@ -0,0 +1,132 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#ifndef __SCREEN_H
+#define __SCREEN_H
+
+#include <stdint.h>
+
+#include "def.h"
+#include "config.h"
+
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+/*
+ * A screen template is a byte code stored in flash.
+ * Each byte which is not an operation code is sent out as character.
+ * Operation codes take the following bytes as arguments.
+ */
+#define SCREEN_OP_END 0x00 // End of the template
+#define SCREEN_OP_MOVE 0x01 // Move cursor: row, column
+#define SCREEN_OP_FILL 0x02 // Repeat character: count, character
+#define SCREEN_OP_TEXT 0x03 // Send string: index in text table
+#define SCREEN_OP_SLOT 0x04 // Dynamic content: slot id
+#define SCREEN_OP_CLEAR 0x05 // Clear the whole screen
+#define SCREEN_OP_REPEAT 0x06 // Repeat block until SCREEN_OP_LOOP: count
+#define SCREEN_OP_LINES 0x07 // Repeat block on each line: count, row, column
+#define SCREEN_OP_LOOP 0x08 // End of a repeated block
+#define SCREEN_OP_ARG 0x09 // Send next argument (screen_printf): type, width
+#define SCREEN_OP_LAST SCREEN_OP_ARG
+
+/*
+ * Argument types of SCREEN_OP_ARG. Numbers are combined with the padding
+ * (uart_pad_t) and padded to the width.
+ */
+#define SCREEN_ARG_NUMBER 0x00 // unsigned int
+#define SCREEN_ARG_NUMBER_LONG 0x10 // uint32_t
+#define SCREEN_ARG_STRING 0x20 // const char * (NUL terminated)
+#define SCREEN_ARG_BYTES 0x30 // const uint8_t *, unsigned int length
+#define SCREEN_ARG_ROW 0x40 // unsigned int row, the column is the width
+#define SCREEN_ARG_TYPE 0xF0
+
+#define SCREEN_END SCREEN_OP_END
+#define SCREEN_MOVE(v, h) SCREEN_OP_MOVE, (v), (h)
+#define SCREEN_FILL(count, c) SCREEN_OP_FILL, (count), (c)
+#define SCREEN_TEXT(index) SCREEN_OP_TEXT, (index)
+#define SCREEN_SLOT(id) SCREEN_OP_SLOT, (id)
+#define SCREEN_CLEAR SCREEN_OP_CLEAR
+#define SCREEN_REPEAT(count) SCREEN_OP_REPEAT, (count)
+#define SCREEN_LINES(count, v, h) SCREEN_OP_LINES, (count), (v), (h)
+#define SCREEN_LOOP SCREEN_OP_LOOP
+#define SCREEN_NUMBER(width, pad) \
+  SCREEN_OP_ARG, SCREEN_ARG_NUMBER | (pad), (width)
+#define SCREEN_NUMBER_LONG(width, pad) \
+  SCREEN_OP_ARG, SCREEN_ARG_NUMBER_LONG | (pad), (width)
+#define SCREEN_STRING SCREEN_OP_ARG, SCREEN_ARG_STRING, 0
+#define SCREEN_BYTES SCREEN_OP_ARG, SCREEN_ARG_BYTES, 0
+#define SCREEN_MOVE_ROW(h) SCREEN_OP_ARG, SCREEN_ARG_ROW, (h)
+
+// Escape character to embed VT100 sequences (Resets the tracked cursor)
+#define SCREEN_ESC 0x1B
+
+// A DEC line size sequence (uart_line_size_t)
+#define SCREEN_LINE_SIZE(size) SCREEN_ESC, '#', (size)
+
+// A box line with the inner size count
+#define SCREEN_BOXLINE(count, edge, fill) \
+  (edge), SCREEN_FILL((count), (fill)), (edge)
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * A screen template with its strings and the callback for dynamic content.
+ * The slot callback gets the slot id and the index of the current repetition
+ * of the surrounding block (0 outside of a block).
+ */
+typedef struct {
+  const uint8_t *code;
+  const char * const *text;
+  void (*slot)(uint8_t id, uint8_t index);
+} screen_t;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+/**
+ * Sends the screen template to the UART interface.
+ * Repeated blocks can't be nested and are executed at least once.
+ *
+ * @param screen The screen template to send
+ */
+void
+screen_send (const screen_t *screen);
+
+/**
+ * Sends the format to the UART interface in a single pass.
+ * A format is a template which takes its dynamic content from the arguments
+ * (SCREEN_OP_ARG) instead of slots. Only the operations END, MOVE, FILL,
+ * CLEAR and ARG can be used.
+ *
+ * @param format The format in flash
+ * @param ... The arguments in the order of the SCREEN_OP_ARG operations
+ */
+void
+screen_printf (const uint8_t *format, ...);
+
+/**
+ * Starts sending the screen template with screen_resume.
+ * Only one template can be sent at a time.
+ *
+ * @param screen The screen template to send
+ */
+void
+screen_start (const screen_t *screen);
+
+/**
+ * Continues sending the template started with screen_start.
+ * An operation is only executed if reserve bytes can be sent without waiting
+ * (see uart_reserve), so reserve must cover the largest operation.
+ * Pass 0 to send the whole template.
+ *
+ * @param reserve The number of bytes required for an operation or 0
+ * @return If the template was sent completely
+ */
+bool_t
+screen_resume (uint8_t reserve);
+
+#endif // !__SCREEN_H
@@ -26,11 +26,21 @@ shift_register_set_leds (uint8_t state);
 
 /**
  * Returns the state of the buttons.
- * The LSB of the state is button PB1.
+ * The LSB of the state is button PB1. The last LED state is written again.
  *
  * @return The binary value of each button
  */
 uint8_t
 shift_register_get_buttons (void);
 
+/**
+ * Writes the LED state and reads the buttons with the same four clock
+ * pulses: SR2 shifts the LEDs in while SR1 shifts the buttons out.
+ *
+ * @param leds The state to write out (The LSB is LED D1)
+ * @return The binary value of each button (The LSB is button PB1)
+ */
+uint8_t
+shift_register_exchange (uint8_t leds);
+
 #endif // !__SHIFT_REGISTER_H
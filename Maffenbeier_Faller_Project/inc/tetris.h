@@ -9,14 +9,15 @@
 #include "def.h"
 #include "config.h"
 
-#include "buffer.h"
+#include "ring.h"
 #include "buttons.h"
 
 // ----------------------------------------------------------------------------
 // Types
 // ----------------------------------------------------------------------------
 
-typedef uint8_t field_item_t;
+typedef uint16_t field_row_t;
+typedef uint32_t field_types_t;
 typedef enum {
   TETROMINO_I = 0x00,
   TETROMINO_T = 0x01,
@@ -24,7 +25,8 @@ typedef enum {
   TETROMINO_Z_INV = 0x03,
   TETROMINO_L = 0x04,
   TETROMINO_L_INV = 0x05,
-  TETROMINO_O = 0x06
+  TETROMINO_O = 0x06,
+  TETROMINO_NONE = 0x07
 } tetromino_t;
 
 typedef enum {
@@ -35,9 +37,18 @@ typedef enum {
   COMMAND_DROP = 0x05
 } tetris_command_t;
 
+/**
+ * The game field is stored as an occupancy bitboard with one word per row.
+ * Column x is stored in bit (x + TETRIS_FIELD_WALL_LEFT) and the unused bits
+ * on both sides are always set, so they act as the walls of the field.
+ * The tetromino type of each cell is stored separately with 3 bits per cell
+ * (Column x in bits 3x to 3x + 2). Empty cells hold TETRIS_CELL_EMPTY, so a
+ * type row describes exactly what is displayed in this row.
+ */
 typedef struct
 {
-  field_item_t data[TETRIS_WIDTH * TETRIS_HEIGHT];
+  field_row_t rows[TETRIS_HEIGHT];
+  field_types_t types[TETRIS_HEIGHT];
 } field_t;
 
 typedef struct
@@ -60,7 +71,26 @@ typedef struct
   uint8_t score_factor;
   uint8_t t_spin;
 
-  buffer_t command_buffer;
+#ifdef TETRIS_DELTA_RENDERING
+  // Columns of each visible row which changed since the row was sent:
+  // The first column in the lower and the last one in the upper nibble
+  uint8_t damage[TETRIS_HEIGHT - TETRIS_TOP_HIDDEN];
+#endif
+  // Stage of a running screen redraw
+  uint8_t redraw;
+
+  // Side panel state: Changed values, the shown score and next tetromino
+  uint8_t dirty;
+  uint32_t shown_score;
+  tetromino_t preview;
+
+  ring_t command_buffer;
+
+  // Set by the timer if the tetromino has to fall down by one row
+  volatile bool_t fall;
+
+  // Set if a frame waits for the end of the frame interval
+  volatile bool_t frame_pending;
 } tetris_t;
 
 // ----------------------------------------------------------------------------
@@ -91,4 +121,20 @@ tetris_game_start (void);
 void
 tetris_game_process (void);
 
+/**
+ * Requests a full redraw of the game screen on the next update.
+ * This re-synchronizes the terminal if its content got lost.
+ */
+void
+tetris_game_redraw (void);
+
+/**
+ * Returns if a frame was held back by the frame interval which already
+ * passed. Call this with disabled interrupts before entering low power mode.
+ *
+ * @return true if tetris_game_process has to send the frame
+ */
+bool_t
+tetris_game_check_pending (void);
+
 #endif // !__TETRIS_H
@@ -13,27 +13,26 @@
 // Types
 // ----------------------------------------------------------------------------
 
+/**
+ * The virtual timers. All of them share the compare channel CCR0 of Timer0_A
+ * which runs continuously from SMCLK / 8 and is moved to the next deadline.
+ * Each user owns its own timer, so new jobs only need a new entry here.
+ */
 typedef enum
 {
-  TIMER_1 = 0x00,
-  TIMER_2 = 0x01
+  TIMER_WELCOME = 0x00, // Welcome screen refresh
+  TIMER_GAME = 0x01, // Falling tetromino
+  TIMER_BUTTONS = 0x02, // Button polling
+  TIMER_FRAME = 0x03 // Minimum interval of the game frames
 } timer_t;
 
-typedef enum
-{
-  TIMER_DIVIDER_1 = 0x00,
-  TIMER_DIVIDER_2 = 0x01,
-  TIMER_DIVIDER_4 = 0x02,
-  TIMER_DIVIDER_8 = 0x03
-} timer_divider_t;
-
 // ----------------------------------------------------------------------------
 // Methods
 // ----------------------------------------------------------------------------
 
 /**
- * Initializes the selected timer. The timer is sourced from the 1MHz SMCLK
- * signal.
+ * Initializes the selected timer in stopped state without a callback.
+ * The first call starts the shared hardware counter.
  *
  * @param timer The timer to initialize
  */
@@ -41,7 +40,8 @@ void
 timer_init (timer_t timer);
 
 /**
- * Starts the selected timer.
+ * Starts the selected timer which calls its callback periodically.
+ * A running timer is restarted.
  *
  * @param timer The timer to start
  */
@@ -49,12 +49,14 @@ void
 timer_start (timer_t timer);
 
 /**
- * Starts the selected timer without enabling the interrupts.
+ * Starts the selected timer which calls its callback once after the period
+ * and stops.
+ * A running timer is restarted.
  *
  * @param timer The timer to start
  */
 void
-timer_start_counter (timer_t timer);
+timer_start_once (timer_t timer);
 
 /**
  * Stops the selected timer.
@@ -65,7 +67,7 @@ void
 timer_stop (timer_t timer);
 
 /**
- * Resets the selected timer.
+ * Restarts the current period of the selected timer if it is running.
  *
  * @param timer The timer to reset
  */
@@ -82,53 +84,49 @@ bool_t
 timer_is_running (timer_t timer);
 
 /**
- * Sets the interval of the selected timer.
- * If the timer is running an interrupt might be created if the current counter
- * is higher than new interval.
+ * Sets the period of the selected timer.
+ * The period is rounded to the resolution of the timers (10 ms). A running
+ * timer uses the new period after its next expiry.
  *
  * @param timer The timer to set
+ * @param period The period in milliseconds (1 to 2550)
  */
 void
-timer_set_interval (timer_t timer, uint16_t interval);
+timer_set_period (timer_t timer, uint16_t period);
 
 /**
- * Returns the current interval of the selected timer.
+ * Returns the period of the selected timer.
  *
  * @param timer The timer to get
+ * @return The period in milliseconds (Rounded to the resolution)
  */
 uint16_t
-timer_get_interval (timer_t timer);
-
-/**
- * Sets the divider for the selected timer.
- *
- * @param timer The timer to modify
- * @param divider The new divider to use
- */
-void
-timer_set_divider (timer_t timer, timer_divider_t divider);
+timer_get_period (timer_t timer);
 
 /**
- * Returns the current divider of the selected timer.
+ * Returns the time of the shared monotonic clock in the resolution of the
+ * timers. The clock only advances while a timer is running, so it measures
+ * durations like the time a button is held down.
  *
- * @param timer The timer to get
+ * @return The time in milliseconds (Wraps around after 65.5 seconds)
  */
-timer_divider_t
-timer_get_divider (timer_t timer);
+uint16_t
+timer_get_time (void);
 
 /**
- * Gets the current value of the timer register.
+ * Gets the current value of the free running counter.
  *
- * @param timer The timer to get
- * @return The current value of the timer register
+ * @return The current value of the counter
  */
 uint16_t
-timer_get_value (timer_t timer);
+timer_get_ticks (void);
 
 /**
  * Sets the callback for the timer which is called on completion.
  * Pass a 0-pointer to deactivate the callback.
  * If the callback returns true the CPU is re-activated from low power mode.
+ * The callback may start and stop timers itself. It runs in the timer
+ * interrupt with disabled interrupts and has to return quickly.
  *
  * @param timer The timer to modify
  * @param callback The callback which is called when the timer is triggered
@@ -9,10 +9,50 @@
 #include "def.h"
 #include "config.h"
 
-#include "buffer.h"
+#include "clock.h"
+#include "ring.h"
+#include "keys.h"
+
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+// Maximum field width of uart_send_number (Digits of a 32-bit value)
+#define UART_NUMBER_WIDTH 10
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+typedef enum
+{
+  UART_LINE_DOUBLE_TOP = '3', // Top half of a double-height line
+  UART_LINE_DOUBLE_BOTTOM = '4', // Bottom half of a double-height line
+  UART_LINE_SINGLE = '5',
+  UART_LINE_DOUBLE_WIDTH = '6'
+} uart_line_size_t;
+
+typedef enum
+{
+  UART_HALF_NONE = 0x00,
+  UART_HALF_TOP = 0x01,
+  UART_HALF_BOTTOM = 0x02
+} uart_half_t;
+
+typedef enum
+{
+  UART_PAD_ZERO = 0x00, // Leading '0's up to the field width
+  UART_PAD_LEFT = 0x01, // Leading spaces (Right aligned)
+  UART_PAD_RIGHT = 0x02 // Trailing spaces (Left aligned)
+} uart_pad_t;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
 
 /**
  * Initializes the UART connection with the specified buffers.
+ * The sizes have to be powers of two (see RING_IS_VALID_SIZE).
  *
  * @param r_buffer A pointer to the receive buffer
  * @param r_size The size of the receive buffer
@@ -20,11 +60,38 @@
  * @param t_size The size of the transmit buffer
  */
 void
-uart_init (uint8_t *r_buffer, uint16_t r_size,
-           uint8_t *t_buffer, uint16_t t_size);
+uart_init (uint8_t *r_buffer, uint8_t r_size,
+           uint8_t *t_buffer, uint8_t t_size);
+
+/**
+ * Switches between the baud rates UART_BAUD and UART_BAUD_FAST after all
+ * queued characters were sent. The host has to follow the switch.
+ * A baud rate measured with UART_AUTO_BAUD is replaced by the selected one
+ * until the host sends the next break and synch field.
+ *
+ * @param fast If UART_BAUD_FAST should be used
+ * @return false if the baud rate can't be generated with the clock profile
+ */
+bool_t
+uart_set_fast (bool_t fast);
 
 /**
- * Puts the character into the queue.
+ * Returns if UART_BAUD_FAST can be generated with the current clock profile
+ * within UART_BAUD_ERROR_MAX.
+ *
+ * @return true if uart_set_fast can switch to the fast baud rate
+ */
+bool_t
+uart_check_fast (void);
+
+/**
+ * Waits in low power mode until all queued characters were sent.
+ */
+void
+uart_flush (void);
+
+/**
+ * Puts the character into the queue. NUL characters are not sent.
  * If the queue is full the execution is interrupted and the
  * CPU is put into sleep mode until the queue ist empty.
  *
@@ -33,6 +100,93 @@ uart_init (uint8_t *r_buffer, uint16_t r_size,
 void
 uart_send (uint8_t c);
 
+/**
+ * Sends the bytes with a single update of the transmit buffer.
+ * The execution is only interrupted if the buffer is full (see uart_send).
+ *
+ * @param data The bytes to send (Without NUL characters)
+ * @param length The number of bytes to send
+ */
+void
+uart_send_bytes (const uint8_t *data, uint8_t length);
+
+/**
+ * Sends the character count times.
+ * Long runs are compressed with a REP sequence if UART_REPEAT is defined.
+ *
+ * @param c The printable character to send
+ * @param count The number of characters to send
+ */
+void
+uart_send_repeat (char c, uint8_t count);
+
+/**
+ * Erases count characters starting at the cursor position.
+ * Long runs are sent as ECH sequence if UART_ERASE is defined which does not
+ * advance the cursor. Use this method only if the cursor is moved afterwards.
+ *
+ * @param count The number of characters to erase
+ */
+void
+uart_send_erase (uint8_t count);
+
+/**
+ * Checks if size bytes can be put into the queue without waiting.
+ * Otherwise the CPU is woken up from low power mode as soon as the
+ * space is available (see uart_check_ready).
+ * Sizes above the queue size only wait for an empty queue.
+ *
+ * @param size The number of bytes to send
+ * @return If the bytes can be sent without waiting
+ */
+bool_t
+uart_reserve (uint8_t size);
+
+/**
+ * Returns the number of received bytes which were lost because the receive
+ * buffer was full or the receiver overran.
+ *
+ * @return The number of lost bytes (Wraps around)
+ */
+uint16_t
+uart_get_dropped (void);
+
+/**
+ * Returns if a space requested by uart_reserve became available or data was
+ * received since the last call.
+ * Call this with disabled interrupts before entering low power mode.
+ *
+ * @return If the CPU was woken up to continue sending or to process data
+ */
+bool_t
+uart_check_ready (void);
+
+/**
+ * Sends the value as ASCII text padded to a fixed field width.
+ * Values with more digits than the width are sent completely.
+ *
+ * @param value The value to send
+ * @param width The width of the field (Up to UART_NUMBER_WIDTH, 0 for none)
+ * @param pad The padding of the field
+ */
+void
+uart_send_number (uint32_t value, uint8_t width, uart_pad_t pad);
+
+/**
+ * Rewrites only the characters of a field which changed since the previous
+ * value was sent with uart_send_number or this method.
+ * The cursor has to be at the start of the field. Afterwards it is located
+ * behind the last character sent.
+ *
+ * @param value The value to send
+ * @param previous The value which is currently shown in the field
+ * @param width The width of the field (Up to UART_NUMBER_WIDTH, 0 for none)
+ * @param pad The padding of the field
+ */
+void
+uart_send_number_update (uint32_t value, uint32_t previous, uint8_t width,
+                         uart_pad_t pad);
+
 /**
  * Sends the 8-bit value as ASCII text to the UART interface.
  *
@@ -79,7 +233,9 @@ void
 uart_send_terminal_init (void);
 
 /**
- * Sends a VT100 command to update the cursor position.
+ * Moves the cursor to the specified position.
+ * The cursor position is tracked and the shortest VT100 motion is sent
+ * (absolute, relative, CR / LF / BS or by re-sending known characters).
  *
  * @param v The row to move to
  * @param h The horizontal position to move to
@@ -87,22 +243,74 @@ uart_send_terminal_init (void);
 void
 uart_send_move_to (uint8_t v, uint8_t h);
 
+/**
+ * Sends a DEC line size command for the line of the cursor.
+ * Double size lines only hold half of the columns.
+ *
+ * @param size The size of the line
+ */
+void
+uart_send_line_size (uart_line_size_t size);
+
+/**
+ * Selects the half of double-height lines addressed by uart_send_move_to.
+ * Row v is then mapped to the terminal rows 2v-1 (top) and 2v (bottom) so
+ * the same content can be sent for both halves.
+ * The mapping is reset when the screen is cleared.
+ *
+ * @param half The half to address or UART_HALF_NONE to disable the mapping
+ */
+void
+uart_set_double_height (uart_half_t half);
+
 /**
  * Sends the '\0'-terminated string out to the UART interface.
+ * Longer strings are not copied but referenced in the transmit buffer so the
+ * string must not change until it was sent (e.g. constants in flash).
  *
  * @param buffer The string to send
  */
 void
-uart_send_string (char *buffer);
+uart_send_string (const char *buffer);
 
 /**
- * Sets the callback function which is called when data was received.
+ * Sets the callback function which is called by uart_process when keys were
+ * received. The buffer holds the decoded keys (keycode_t).
  * Pass 0 to this function to deactivate the callback.
- * If the callback returns true the CPU is re-activated from low power mode.
+ * Keys which are left in the buffer are passed again with the next
+ * received data.
  *
  * @param callback The callback function to notify
  */
 void
-uart_set_receive_callback (bool_t (*callback)(buffer_t *buffer));
+uart_set_receive_callback (bool_t (*callback)(ring_t *buffer));
+
+/**
+ * Passes the received data to the receive callback.
+ * Call this from the main loop after the CPU was woken up.
+ *
+ * @return The result of the callback or false if no data was received
+ */
+bool_t
+uart_process (void);
+
+/**
+ * Sets the callback function which returns the character currently displayed
+ * at the terminal position (v, h) or '\0' if it is unknown.
+ * Cursor motions re-send known characters if this is cheaper than an
+ * escape sequence. The callback is removed when the screen is cleared.
+ *
+ * @param callback The callback function to query
+ */
+void
+uart_set_screen_callback (char (*callback)(uint8_t v, uint8_t h));
+
+/**
+ * Forgets the tracked cursor position and removes the screen callback.
+ * Use this if the terminal content may differ from the sent data, so the
+ * next cursor motion is absolute and no characters are re-sent.
+ */
+void
+uart_invalidate_screen (void);
 
 #endif // !__UART_H
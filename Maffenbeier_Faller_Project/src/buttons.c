@@ -27,94 +27,236 @@ buttons_init (buttons_t *buffer)
   P1REN |= BIT3 | BIT4; // Enable pull-up / down resistors
   P1OUT |= BIT3 | BIT4; // Set to pull-up
 
-  // Load initial states
-  uint8_t sr_state = shift_register_get_buttons();
-  for (uint8_t i = BUTTON_COUNT; i-- > 0;)
-  {
-    switch (i)
-    {
-    case BUTTON_1:
-    case BUTTON_2:
-    case BUTTON_3:
-    case BUTTON_4:
-      buffer->state[i] = ((sr_state >> (3 - i)) & 0x01)
-          ? BUTTON_STATE_PRESSED : 0;
-      break;
-    case BUTTON_5:
-      buffer->state[i] = (P1IN & BIT3) ? 0 : BUTTON_STATE_PRESSED;
-      break;
-    case BUTTON_6:
-      buffer->state[i] = (P1IN & BIT4) ? 0 : BUTTON_STATE_PRESSED;
-      break;
-    }
-  }
+  // Buttons held down during start up aren't reported
+  state->pressed = buttons_read();
+  state->count0 = 0;
+  state->count1 = 0;
 
-  // Disable callback function
+  // Disable callback function without queued events
+  state->e_head = 0;
+  state->e_tail = 0;
   state->callback = 0;
+  state->mask = BUTTON_MASK_ALL;
+  state->repeat = 0;
+  state->hold = BUTTON_NONE;
+
+  // Poll the buttons until they are idle
+  timer_init(TIMER_BUTTONS);
+  timer_set_period(TIMER_BUTTONS, BUTTON_POLL_PERIOD);
+  timer_set_callback(TIMER_BUTTONS, &buttons_on_timer);
+  timer_start(TIMER_BUTTONS);
 
-  // Initialize timer to check the buttons every 50 ms
-  // This timer is also used to seed the RNG
-  timer_init(TIMER_2);
-  timer_set_divider(TIMER_2, TIMER_DIVIDER_1);
-  timer_set_interval(TIMER_2, 0xC350); // Every 50 ms
-  timer_set_callback(TIMER_2, &buttons_on_timer2);
-  timer_start(TIMER_2);
+  // Presses of PB5 and PB6 create falling edges (Enabled once idle)
+  P1IES |= BUTTON_PORT_PINS;
 }
 
 void
-buttons_set_callback (bool_t (*callback)(button_t))
+buttons_set_callback (bool_t (*callback)(const button_event_t *event))
 {
   state->callback = callback;
 }
 
+void
+buttons_set_mask (uint8_t mask)
+{
+  state->mask = mask;
+
+  // The timer stops itself as soon as the buttons are idle
+  if ((mask & BUTTON_MASK_SHIFT_REGISTER) && !timer_is_running(TIMER_BUTTONS))
+  {
+    P1IE &= ~BUTTON_PORT_PINS;
+    timer_start(TIMER_BUTTONS);
+  }
+}
+
+void
+buttons_set_repeat (uint8_t mask)
+{
+  state->repeat = mask;
+}
+
+bool_t
+buttons_process (void)
+{
+  bool_t result = 0x00;
+
+  while (state->e_tail != state->e_head)
+  {
+    // Copy the event before the interrupt can overwrite it
+    button_event_t event
+        = state->events[state->e_tail & (BUTTON_EVENT_BUFFER_SIZE - 1)];
+    state->e_tail++;
+
+    // The callback may be changed by the previous call
+    if (state->callback)
+      result |= state->callback(&event);
+  }
+
+  return result;
+}
+
+bool_t
+buttons_check_pending (void)
+{
+  return (state->e_tail != state->e_head);
+}
+
 bool_t
-buttons_on_timer2 (void)
+buttons_on_timer (void)
 {
-  // Enable reentrant interrupts for UART
-  __enable_interrupt();
+  bool_t wake_cpu = buttons_sample();
+  if (!buttons_check_idle())
+    return wake_cpu;
+
+  // Wait for the next press without waking up
+  timer_stop(TIMER_BUTTONS);
+  P1IFG &= ~BUTTON_PORT_PINS;
+  P1IE |= BUTTON_PORT_PINS;
+
+  // A press after the last sample didn't set the flag
+  P1IFG |= ~P1IN & BUTTON_PORT_PINS;
+
+  return wake_cpu;
+}
 
-  uint8_t wake_cpu = 0x00;
+static __inline uint8_t
+buttons_read (void)
+{
+  // PB5 and PB6 pull P1.3 and P1.4 low
+  return shift_register_get_buttons() | ((~P1IN & BUTTON_PORT_PINS) << 1);
+}
 
-  uint8_t sr_state = shift_register_get_buttons();
-  for (uint8_t i = BUTTON_COUNT; i-- > 0;)
+static bool_t
+buttons_sample (void)
+{
+  // Buttons outside the mask read as released
+  uint8_t buttons = (state->mask & BUTTON_MASK_SHIFT_REGISTER)
+      ? buttons_read() : ((~P1IN & BUTTON_PORT_PINS) << 1);
+  buttons &= state->mask;
+
+  // Count the differing samples and reset the counters of the others
+  uint8_t delta = buttons ^ state->pressed;
+  state->count1 = (state->count1 ^ state->count0) & delta;
+  state->count0 = ~state->count0 & delta;
+
+  // Buttons whose counter wrapped around change their state
+  uint8_t changed = delta & ~(state->count0 | state->count1);
+
+  uint16_t time = timer_get_time();
+  bool_t wake_cpu = 0x00;
+
+  for (uint8_t i = 0; changed != 0; ++i, changed >>= 1)
+  {
+    if (!(changed & 0x01))
+      continue;
+
+    uint8_t type = (state->pressed & BUTTON_MASK(i))
+        ? BUTTON_RELEASE : BUTTON_PRESS;
+    if (!buttons_queue(type, i, time))
+    {
+      // Keep the counters of the remaining changes at the wrap around, so
+      // they are retried with the next sample
+      state->count0 |= changed << i;
+      state->count1 |= changed << i;
+      break;
+    }
+
+    state->pressed ^= BUTTON_MASK(i);
+    wake_cpu = 0x01;
+
+    if (type == BUTTON_RELEASE)
+      continue;
+
+    // The last pressed button takes over the long press and the repeat
+    state->hold = i;
+    state->hold_long = 0x00;
+    state->hold_time = time;
+    state->hold_repeat = time + BUTTON_REPEAT_DELAY;
+  }
+
+  if (state->hold == BUTTON_NONE)
+    return wake_cpu;
+
+  if (!(state->pressed & BUTTON_MASK(state->hold)))
   {
-    if (!(state->state[i] & BUTTON_TIMER_MASK))
+    // A repeating button which is still held down continues after the delay
+    uint8_t remaining = state->pressed & state->repeat;
+    if (!remaining)
     {
-      uint16_t old_state = state->state[i] & BUTTON_STATE_PRESSED;
-      uint16_t new_state;
-      switch (i)
-      {
-      case BUTTON_1:
-      case BUTTON_2:
-      case BUTTON_3:
-      case BUTTON_4:
-        new_state = (sr_state >> (3 - i)) & 0x01;
-        break;
-      case BUTTON_5:
-        new_state = (P1IN & BIT3) ? 0 : 1;
-        break;
-      case BUTTON_6:
-        new_state = (P1IN & BIT4) ? 0 : 1;
-        break;
-      }
-
-      // Did the state change?
-      if ((old_state && !new_state) || (!old_state && new_state)) {
-        if (new_state)
-        {
-          state->state[i] = BUTTON_WAIT_TIME | BUTTON_STATE_PRESSED;
-
-          // Notify listener
-          if (state->callback)
-            wake_cpu |= state->callback((button_t) i);
-        }
-        else
-          state->state[i] = BUTTON_WAIT_TIME;
-      }
-    } else {
-      state->state[i]--;
+      state->hold = BUTTON_NONE;
+      return wake_cpu;
     }
+
+    uint8_t i = 0;
+    while (!(remaining & 0x01))
+    {
+      remaining >>= 1;
+      i++;
+    }
+
+    state->hold = i;
+    state->hold_long = 0x01;
+    state->hold_time = time;
+    state->hold_repeat = time + BUTTON_REPEAT_DELAY;
+  }
+
+  // Long press and repeat events are retried with the next sample as well
+  if (!state->hold_long
+      && (uint16_t) (time - state->hold_time) >= BUTTON_LONG_PRESS_TIME
+      && buttons_queue(BUTTON_LONG_PRESS, state->hold, time))
+  {
+    state->hold_long = 0x01;
+    wake_cpu = 0x01;
+  }
+
+  if ((state->repeat & BUTTON_MASK(state->hold))
+      && (int16_t) (time - state->hold_repeat) >= 0
+      && buttons_queue(BUTTON_REPEAT, state->hold, time))
+  {
+    state->hold_repeat += BUTTON_REPEAT_PERIOD;
+    wake_cpu = 0x01;
   }
 
   return wake_cpu;
 }
+
+static bool_t
+buttons_queue (uint8_t type, uint8_t button, uint16_t time)
+{
+  uint8_t head = state->e_head;
+
+  // The caller keeps the state change if the listener didn't keep up
+  if ((uint8_t) (head - state->e_tail) >= BUTTON_EVENT_BUFFER_SIZE)
+    return 0x00;
+
+  button_event_t *event = &state->events[head & (BUTTON_EVENT_BUFFER_SIZE - 1)];
+  event->type = type;
+  event->button = button;
+  event->time = time;
+
+  // Store the event before it gets visible to the main loop
+  state->e_head = head + 1;
+  return 0x01;
+}
+
+static bool_t
+buttons_check_idle (void)
+{
+  if (state->mask & BUTTON_MASK_SHIFT_REGISTER)
+    return 0x00;
+
+  return !(state->pressed | state->count0 | state->count1);
+}
+
+#pragma vector=PORT1_VECTOR
+__interrupt void
+buttons_on_port (void)
+{
+  // Poll until all buttons are released and debounced
+  P1IE &= ~BUTTON_PORT_PINS;
+  P1IFG &= ~BUTTON_PORT_PINS;
+  timer_start(TIMER_BUTTONS);
+
+  if (buttons_sample())
+    __bic_SR_register_on_exit(CPUOFF);
+}
@@ -4,12 +4,61 @@
 #ifndef __BUTTONS_P_H
 #define __BUTTONS_P_H
 
+#if !RING_IS_VALID_SIZE(BUTTON_EVENT_BUFFER_SIZE)
+#error "BUTTON_EVENT_BUFFER_SIZE has to be a power of two up to 128"
+#endif
+
+// PB5 and PB6 on port 1 (Pulled up, low while pressed)
+#define BUTTON_PORT_PINS (BIT3 | BIT4)
+
+// Sampling period while a button is down or debounced
+// A change is accepted after 4 equal samples (30 to 40 ms)
+#define BUTTON_POLL_PERIOD 10
+
 /**
- * Callback function for timer 2 interrupt.
+ * Callback function for the button timer.
  *
  * @return true if the CPU should be woken up
  */
 bool_t
-buttons_on_timer2 (void);
+buttons_on_timer (void);
+
+/**
+ * Reads the state of all buttons.
+ *
+ * @return The pressed buttons (BUTTON_MASK)
+ */
+static __inline uint8_t
+buttons_read (void);
+
+/**
+ * Samples the buttons of the mask and queues the events.
+ * A state change is only taken over together with its event, so no event
+ * gets lost while the queue is full.
+ *
+ * @return true if an event was queued
+ */
+static bool_t
+buttons_sample (void);
+
+/**
+ * Appends an event for the main loop.
+ *
+ * @param type The type of the event
+ * @param button The button of the event
+ * @param time The time of the event (timer_get_time)
+ * @return true if the event was queued
+ */
+static bool_t
+buttons_queue (uint8_t type, uint8_t button, uint16_t time);
+
+/**
+ * Returns if all buttons are released and debounced and the shift register
+ * doesn't have to be polled.
+ *
+ * @return true if the sampling can stop
+ */
+static bool_t
+buttons_check_idle (void);
 
 #endif // !__BUTTONS_P_H
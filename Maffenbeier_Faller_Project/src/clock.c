@@ -0,0 +1,63 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#include <msp430.h>
+#include <stdint.h>
+
+#include "inc/def.h"
+#include "inc/config.h"
+
+#include "inc/clock.h"
+
+#include "clock_p.h"
+
+// ----------------------------------------------------------------------------
+// Fields
+// ----------------------------------------------------------------------------
+
+static clock_profile_t clock_profile;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+void
+clock_init (clock_profile_t profile)
+{
+  if (!clock_apply(profile))
+    clock_apply(CLOCK_1MHZ);
+
+  // SMCLK = DCO / 1
+  BCSCTL2 = SELM_0 | DIVM_0 | DIVS_0;
+}
+
+clock_profile_t
+clock_get_profile (void)
+{
+  return clock_profile;
+}
+
+uint16_t
+clock_get_frequency (void)
+{
+  return CLOCK_PROFILES[clock_profile].frequency;
+}
+
+static bool_t
+clock_apply (clock_profile_t profile)
+{
+  if (profile >= CLOCK_PROFILE_COUNT)
+    return 0x00;
+
+  const clock_config_t *config = &CLOCK_PROFILES[profile];
+  if (*config->bcsctl1 == CLOCK_NOT_CALIBRATED)
+    return 0x00;
+
+  // Select the lowest DCO tap first so the frequency can't overshoot
+  DCOCTL = 0;
+  BCSCTL1 = *config->bcsctl1;
+  DCOCTL = *config->dcoctl;
+
+  clock_profile = profile;
+  return 0x01;
+}
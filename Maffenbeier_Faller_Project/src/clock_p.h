@@ -0,0 +1,55 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#ifndef __CLOCK_P_H
+#define __CLOCK_P_H
+
+#include <msp430.h>
+#include <stdint.h>
+
+#include "inc/clock.h"
+
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+// Value of erased calibration data
+#define CLOCK_NOT_CALIBRATED 0xFF
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * Location of the calibration data in the information memory.
+ */
+typedef struct {
+  volatile const uint8_t *bcsctl1;
+  volatile const uint8_t *dcoctl;
+  uint16_t frequency; // kHz
+} clock_config_t;
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+
+static const clock_config_t CLOCK_PROFILES[CLOCK_PROFILE_COUNT] = {
+  {&CALBC1_1MHZ, &CALDCO_1MHZ, CLOCK_1MHZ_FREQUENCY / 1000},
+  {&CALBC1_8MHZ, &CALDCO_8MHZ, CLOCK_8MHZ_FREQUENCY / 1000},
+  {&CALBC1_16MHZ, &CALDCO_16MHZ, CLOCK_16MHZ_FREQUENCY / 1000}
+};
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+/**
+ * Sets up the DCO with the calibration data of the profile.
+ *
+ * @param profile The profile to use
+ * @return false if the profile isn't calibrated
+ */
+static bool_t
+clock_apply (clock_profile_t profile);
+
+#endif // !__CLOCK_P_H
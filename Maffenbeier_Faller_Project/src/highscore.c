@@ -8,8 +8,10 @@
 #include "inc/config.h"
 
 #include "inc/util.h"
+#include "inc/clock.h"
 #include "inc/wdt.h"
 #include "inc/uart.h"
+#include "inc/screen.h"
 #include "inc/buttons.h"
 #include "inc/highscore.h"
 
@@ -23,6 +25,18 @@ static highscore_t highscore_c;
 
 static highscore_state_t* state;
 
+static const screen_t highscore_input_screen = {
+  HIGHSCORE_INPUT_SCREEN, HIGHSCORE_TEXT, &highscore_on_slot
+};
+
+static const screen_t highscore_clear_screen = {
+  HIGHSCORE_CLEAR_SCREEN, HIGHSCORE_TEXT, &highscore_on_slot
+};
+
+static const screen_t highscore_screen = {
+  HIGHSCORE_SCREEN, HIGHSCORE_TEXT, &highscore_on_slot
+};
+
 void
 highscore_init (uint32_t score, highscore_state_t *working_area)
 {
@@ -31,11 +45,13 @@ highscore_init (uint32_t score, highscore_state_t *working_area)
   state->clear_shown = 0x00;
   state->enter_name_shown = 0x00;
 
-  // Initialize flash controller
+  // Initialize flash controller with the smallest SMCLK divisor which keeps
+  // the timing generator within its frequency range
   FCTL1 = FWKEY; // Write password
   FCTL2 = FWKEY // Write password
       | FSSEL_2 // SMCLK as source
-      | 0x03F; // FN Divisor of 64
+      | ((clock_get_frequency() + HIGHSCORE_FLASH_CLOCK_MAX - 1)
+          / HIGHSCORE_FLASH_CLOCK_MAX - 1); // FN Divisor - 1
   FCTL3 = FWKEY // Write password
       | LOCK; // Lock flash memory (read only)
 
@@ -64,6 +80,8 @@ highscore_init (uint32_t score, highscore_state_t *working_area)
 
   uart_set_receive_callback(&highscore_on_key);
   buttons_set_callback(&highscore_on_button);
+  buttons_set_mask(BUTTON_MASK_ALL);
+  buttons_set_repeat(BUTTON_MASK(BUTTON_3) | BUTTON_MASK(BUTTON_4));
 }
 
 void
@@ -412,210 +430,87 @@ highscore_prev_char (uint8_t c)
 static __inline void
 highscore_show_input_dialog (void)
 {
-  uart_send_move_to(0, 1);
-  uart_send_cls();
-
-  const uint8_t box_size = MAX(HIGHSCORE_NAME_LENGTH + 4, 19);
-  uint8_t y_position = HIGHSCORE_INPUT_Y;
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position, HIGHSCORE_INPUT_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send_string(" Score: ");
-  uart_send_number_u32(state->new_entry.score, 1);
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X + box_size + 1);
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position, HIGHSCORE_INPUT_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send_string(" Enter your name: ");
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X + box_size + 1);
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position, HIGHSCORE_INPUT_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send(' ');
-  for (uint8_t i = 0; i < HIGHSCORE_NAME_LENGTH; i++)
-  {
-    if (i >= state->new_entry.name_length)
-      uart_send('_');
-    else
-      uart_send(state->new_entry.name[i]);
-  }
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X + box_size + 1);
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position, HIGHSCORE_INPUT_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X + box_size - 7);
-  uart_send_number_u8(state->new_entry.name_length, 1);
-  uart_send('/');
-  uart_send_number_u8(HIGHSCORE_NAME_LENGTH, 1);
-  uart_send(' ');
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H);
-
-  y_position++;
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  uart_send_string("Press ENTER (5) to finish ...");
+  screen_send(&highscore_input_screen);
 }
 
 static __inline void
 highscore_show_clear_dialog (void)
 {
-  uart_send_move_to(0, 1);
-  uart_send_cls();
-
-  const uint8_t box_size = 23;
-  uint8_t y_position = HIGHSCORE_INPUT_Y;
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position, HIGHSCORE_INPUT_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send_string(" Do you really want to ");
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X + box_size + 1);
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position, HIGHSCORE_INPUT_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send_string(" delete all scores? ");
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X + box_size + 1);
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position, HIGHSCORE_INPUT_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send_string(" (Y)es (5)");
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X + box_size - 8);
-  uart_send_string("(N)o (6) ");
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position++, HIGHSCORE_INPUT_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H);
+  screen_send(&highscore_clear_screen);
 }
 
 static __inline void
 highscore_show_scoreboard (void)
 {
-  const uint8_t box_size = HIGHSCORE_NAME_LENGTH + 22;
-
-  uart_send_move_to(0, 1);
-  uart_send_cls();
-
-  uint8_t y_position = HIGHSCORE_Y;
-
-  uart_send_move_to(y_position++, HIGHSCORE_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H);
-
-  uart_send_move_to(y_position++, HIGHSCORE_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position, HIGHSCORE_X);
-  uart_send(HIGHSCORE_BORDER_V);
-  uart_send_string(" Highscore:");
-  uart_send_move_to(y_position++, HIGHSCORE_X + box_size + 1);
-  uart_send(HIGHSCORE_BORDER_V);
-
-  uart_send_move_to(y_position++, HIGHSCORE_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
+  screen_send(&highscore_screen);
+}
 
-  highscore_t *table = state->current_segment;
-  for (uint8_t i = 0; i < HIGHSCORE_LENGTH; ++i)
+static void
+highscore_on_slot (uint8_t slot, uint8_t index)
+{
+  switch (slot)
   {
-    uart_send_move_to(y_position, HIGHSCORE_X);
-    uart_send(HIGHSCORE_BORDER_V);
-    uart_send(' ');
-    uart_send_number_u8(i + 1, 1);
-    uart_send(':');
-    uart_send(' ');
-
-    if (i >= state->current_segment->entry_count
-        || state->current_segment->initialized == HIGHSCORE_SEGMENT_EMPTY)
-    {
-      uart_send_string("Empty");
-      uart_send_move_to(y_position++, HIGHSCORE_X + box_size + 1);
-    }
-    else
+  case HIGHSCORE_SLOT_SCORE:
+    uart_send_number_u32(state->new_entry.score, 1);
+    break;
+  case HIGHSCORE_SLOT_NAME:
     {
-      for (uint8_t j = 0; (j < table->entries[i].name_length)
-          && (j < HIGHSCORE_NAME_LENGTH); ++j)
+      uint8_t name[HIGHSCORE_NAME_LENGTH];
+      for (uint8_t i = 0; i < HIGHSCORE_NAME_LENGTH; i++)
       {
-        uart_send(table->entries[i].name[j]);
+        if (i >= state->new_entry.name_length)
+          name[i] = '_';
+        else
+          name[i] = state->new_entry.name[i];
       }
 
-      uart_send_move_to(y_position++, HIGHSCORE_X + box_size - 10);
-      uart_send_number_u32(table->entries[i].score, 1);
-      uart_send(' ');
+      uart_send_bytes(name, HIGHSCORE_NAME_LENGTH);
+      break;
     }
+  case HIGHSCORE_SLOT_NAME_LENGTH:
+    screen_printf(HIGHSCORE_NAME_LENGTH_FORMAT, state->new_entry.name_length,
+                  HIGHSCORE_NAME_LENGTH);
+    break;
+  case HIGHSCORE_SLOT_ENTRY:
+    {
+      highscore_t *table = state->current_segment;
+      uint8_t y_position = HIGHSCORE_Y + 4 + index;
 
-    uart_send(HIGHSCORE_BORDER_V);
-  }
-
-  uart_send_move_to(y_position++, HIGHSCORE_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_V, ' ');
-
-  uart_send_move_to(y_position++, HIGHSCORE_X);
-  highscore_send_boxline(box_size, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H);
+      if (index >= table->entry_count
+          || table->initialized == HIGHSCORE_SEGMENT_EMPTY)
+      {
+        screen_printf(HIGHSCORE_EMPTY_FORMAT, index + 1,
+                      HIGHSCORE_TEXT[HIGHSCORE_TEXT_EMPTY], y_position);
+        break;
+      }
 
-  y_position++;
-  if (state->current_segment->initialized != HIGHSCORE_SEGMENT_EMPTY)
-  {
-    uart_send_move_to(y_position++, HIGHSCORE_X);
-    uart_send_string("Press L (4) to delete all highscores ...");
+      // The flash may be rewritten while sending so the name is copied
+      screen_printf(HIGHSCORE_ENTRY_FORMAT, index + 1,
+                    table->entries[index].name,
+                    MIN(table->entries[index].name_length,
+                        HIGHSCORE_NAME_LENGTH),
+                    y_position, table->entries[index].score);
+      break;
+    }
+  case HIGHSCORE_SLOT_HINTS:
+    if (state->current_segment->initialized != HIGHSCORE_SEGMENT_EMPTY)
+      screen_printf(HIGHSCORE_HINTS_FORMAT,
+                    HIGHSCORE_TEXT[HIGHSCORE_TEXT_DELETE],
+                    HIGHSCORE_TEXT[HIGHSCORE_TEXT_EXIT]);
+    else
+      screen_printf(HIGHSCORE_EXIT_FORMAT,
+                    HIGHSCORE_TEXT[HIGHSCORE_TEXT_EXIT]);
+    break;
   }
-
-  uart_send_move_to(y_position++, HIGHSCORE_X);
-  uart_send_string("Press E (5) to exit ...");
-}
-
-static __inline void
-highscore_send_boxline (uint8_t count, uint8_t edge, uint8_t fill)
-{
-  uart_send(edge);
-  for (; count-- > 0;)
-    uart_send(fill);
-  uart_send(edge);
 }
 
 static bool_t
-highscore_on_key (buffer_t *buffer)
+highscore_on_key (ring_t *buffer)
 {
   bool_t wake_cpu = 0x00;
-  while (!buffer_is_empty(buffer))
+  while (!ring_is_empty(buffer))
   {
-    uint8_t key = buffer_dequeue(buffer);
+    uint8_t key = ring_get(buffer);
 
     // Executed if the dialog 'delete highscore' is shown
     if (state->clear_shown)
@@ -697,8 +592,19 @@ highscore_on_key (buffer_t *buffer)
 }
 
 static bool_t
-highscore_on_button (button_t button)
+highscore_on_button (const button_event_t *event)
 {
+  button_t button = (button_t) event->button;
+
+  // Only the character selection repeats
+  if (event->type == BUTTON_REPEAT)
+  {
+    if (!state->enter_name_shown || state->clear_shown)
+      return 0x00;
+  }
+  else if (event->type != BUTTON_PRESS)
+    return 0x00;
+
   // Executed if the dialog 'delete highscore' is shown
   if (state->clear_shown)
   {
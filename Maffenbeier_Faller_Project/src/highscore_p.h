@@ -8,6 +8,209 @@
 
 #include "inc/highscore.h"
 #include "inc/buttons.h"
+#include "inc/screen.h"
+#include "inc/uart.h"
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+
+#define HIGHSCORE_INPUT_BOX_SIZE MAX(HIGHSCORE_NAME_LENGTH + 4, 19)
+#define HIGHSCORE_CLEAR_BOX_SIZE 23
+#define HIGHSCORE_BOX_SIZE (HIGHSCORE_NAME_LENGTH + 22)
+
+// Maximum frequency of the flash timing generator (257 - 476 kHz)
+#define HIGHSCORE_FLASH_CLOCK_MAX 476 // kHz
+
+// Slots of the screen templates
+#define HIGHSCORE_SLOT_SCORE 0x00
+#define HIGHSCORE_SLOT_NAME 0x01
+#define HIGHSCORE_SLOT_NAME_LENGTH 0x02
+#define HIGHSCORE_SLOT_ENTRY 0x03
+#define HIGHSCORE_SLOT_HINTS 0x04
+
+// Indices of the text table
+#define HIGHSCORE_TEXT_SCORE 0x00
+#define HIGHSCORE_TEXT_ENTER_NAME 0x01
+#define HIGHSCORE_TEXT_FINISH 0x02
+#define HIGHSCORE_TEXT_CLEAR_1 0x03
+#define HIGHSCORE_TEXT_CLEAR_2 0x04
+#define HIGHSCORE_TEXT_YES 0x05
+#define HIGHSCORE_TEXT_NO 0x06
+#define HIGHSCORE_TEXT_TITLE 0x07
+#define HIGHSCORE_TEXT_EMPTY 0x08
+#define HIGHSCORE_TEXT_DELETE 0x09
+#define HIGHSCORE_TEXT_EXIT 0x0A
+
+static const char * const HIGHSCORE_TEXT[11] = {
+  " Score: ",
+  " Enter your name: ",
+  "Press ENTER (5) to finish ...",
+  " Do you really want to ",
+  " delete all scores? ",
+  " (Y)es (5)",
+  "(N)o (6) ",
+  " Highscore:",
+  "Empty",
+  "Press L (4) to delete all highscores ...",
+  "Press E (5) to exit ..."
+};
+
+/*
+ * Template of the name input dialog.
+ */
+static const uint8_t HIGHSCORE_INPUT_SCREEN[] = {
+  SCREEN_CLEAR,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_INPUT_BOX_SIZE, HIGHSCORE_BORDER_C,
+                 HIGHSCORE_BORDER_H),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 1, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_INPUT_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 2, HIGHSCORE_INPUT_X),
+  HIGHSCORE_BORDER_V, SCREEN_TEXT(HIGHSCORE_TEXT_SCORE),
+  SCREEN_SLOT(HIGHSCORE_SLOT_SCORE),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 2,
+              HIGHSCORE_INPUT_X + HIGHSCORE_INPUT_BOX_SIZE + 1),
+  HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 3, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_INPUT_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 4, HIGHSCORE_INPUT_X),
+  HIGHSCORE_BORDER_V, SCREEN_TEXT(HIGHSCORE_TEXT_ENTER_NAME),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 4,
+              HIGHSCORE_INPUT_X + HIGHSCORE_INPUT_BOX_SIZE + 1),
+  HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 5, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_INPUT_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 6, HIGHSCORE_INPUT_X),
+  HIGHSCORE_BORDER_V, ' ', SCREEN_SLOT(HIGHSCORE_SLOT_NAME),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 6,
+              HIGHSCORE_INPUT_X + HIGHSCORE_INPUT_BOX_SIZE + 1),
+  HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 7, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_INPUT_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 8, HIGHSCORE_INPUT_X),
+  HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 8,
+              HIGHSCORE_INPUT_X + HIGHSCORE_INPUT_BOX_SIZE - 7),
+  SCREEN_SLOT(HIGHSCORE_SLOT_NAME_LENGTH), ' ', HIGHSCORE_BORDER_V,
+
+  SCREEN_LINES(2, HIGHSCORE_INPUT_Y + 9, HIGHSCORE_INPUT_X),
+    SCREEN_BOXLINE(HIGHSCORE_INPUT_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+  SCREEN_LOOP,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 11, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_INPUT_BOX_SIZE, HIGHSCORE_BORDER_C,
+                 HIGHSCORE_BORDER_H),
+
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 13, HIGHSCORE_INPUT_X),
+  SCREEN_TEXT(HIGHSCORE_TEXT_FINISH),
+  SCREEN_END
+};
+
+/*
+ * Template of the clear highscore dialog.
+ */
+static const uint8_t HIGHSCORE_CLEAR_SCREEN[] = {
+  SCREEN_CLEAR,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_CLEAR_BOX_SIZE, HIGHSCORE_BORDER_C,
+                 HIGHSCORE_BORDER_H),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 1, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_CLEAR_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 2, HIGHSCORE_INPUT_X),
+  HIGHSCORE_BORDER_V, SCREEN_TEXT(HIGHSCORE_TEXT_CLEAR_1),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 2,
+              HIGHSCORE_INPUT_X + HIGHSCORE_CLEAR_BOX_SIZE + 1),
+  HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 3, HIGHSCORE_INPUT_X),
+  HIGHSCORE_BORDER_V, SCREEN_TEXT(HIGHSCORE_TEXT_CLEAR_2),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 3,
+              HIGHSCORE_INPUT_X + HIGHSCORE_CLEAR_BOX_SIZE + 1),
+  HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 4, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_CLEAR_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 5, HIGHSCORE_INPUT_X),
+  HIGHSCORE_BORDER_V, SCREEN_TEXT(HIGHSCORE_TEXT_YES),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 5,
+              HIGHSCORE_INPUT_X + HIGHSCORE_CLEAR_BOX_SIZE - 8),
+  SCREEN_TEXT(HIGHSCORE_TEXT_NO), HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 6, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_CLEAR_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+  SCREEN_MOVE(HIGHSCORE_INPUT_Y + 7, HIGHSCORE_INPUT_X),
+  SCREEN_BOXLINE(HIGHSCORE_CLEAR_BOX_SIZE, HIGHSCORE_BORDER_C,
+                 HIGHSCORE_BORDER_H),
+  SCREEN_END
+};
+
+/*
+ * Template of the highscore table.
+ */
+static const uint8_t HIGHSCORE_SCREEN[] = {
+  SCREEN_CLEAR,
+  SCREEN_MOVE(HIGHSCORE_Y, HIGHSCORE_X),
+  SCREEN_BOXLINE(HIGHSCORE_BOX_SIZE, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H),
+  SCREEN_MOVE(HIGHSCORE_Y + 1, HIGHSCORE_X),
+  SCREEN_BOXLINE(HIGHSCORE_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_MOVE(HIGHSCORE_Y + 2, HIGHSCORE_X),
+  HIGHSCORE_BORDER_V, SCREEN_TEXT(HIGHSCORE_TEXT_TITLE),
+  SCREEN_MOVE(HIGHSCORE_Y + 2, HIGHSCORE_X + HIGHSCORE_BOX_SIZE + 1),
+  HIGHSCORE_BORDER_V,
+  SCREEN_MOVE(HIGHSCORE_Y + 3, HIGHSCORE_X),
+  SCREEN_BOXLINE(HIGHSCORE_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+
+  SCREEN_LINES(HIGHSCORE_LENGTH, HIGHSCORE_Y + 4, HIGHSCORE_X),
+    HIGHSCORE_BORDER_V, ' ', SCREEN_SLOT(HIGHSCORE_SLOT_ENTRY),
+    HIGHSCORE_BORDER_V,
+  SCREEN_LOOP,
+
+  SCREEN_MOVE(HIGHSCORE_Y + HIGHSCORE_LENGTH + 4, HIGHSCORE_X),
+  SCREEN_BOXLINE(HIGHSCORE_BOX_SIZE, HIGHSCORE_BORDER_V, ' '),
+  SCREEN_MOVE(HIGHSCORE_Y + HIGHSCORE_LENGTH + 5, HIGHSCORE_X),
+  SCREEN_BOXLINE(HIGHSCORE_BOX_SIZE, HIGHSCORE_BORDER_C, HIGHSCORE_BORDER_H),
+
+  SCREEN_SLOT(HIGHSCORE_SLOT_HINTS),
+  SCREEN_END
+};
+
+/*
+ * Formats of the dynamic content (screen_printf).
+ */
+static const uint8_t HIGHSCORE_NAME_LENGTH_FORMAT[] = {
+  SCREEN_NUMBER(3, UART_PAD_ZERO), '/', SCREEN_NUMBER(3, UART_PAD_ZERO),
+  SCREEN_END
+};
+
+// Arguments: Position, text, row
+static const uint8_t HIGHSCORE_EMPTY_FORMAT[] = {
+  SCREEN_NUMBER(3, UART_PAD_ZERO), ':', ' ', SCREEN_STRING,
+  SCREEN_MOVE_ROW(HIGHSCORE_X + HIGHSCORE_BOX_SIZE + 1),
+  SCREEN_END
+};
+
+// Arguments: Position, name, name length, row, score
+static const uint8_t HIGHSCORE_ENTRY_FORMAT[] = {
+  SCREEN_NUMBER(3, UART_PAD_ZERO), ':', ' ', SCREEN_BYTES,
+  SCREEN_MOVE_ROW(HIGHSCORE_X + HIGHSCORE_BOX_SIZE - 10),
+  SCREEN_NUMBER_LONG(10, UART_PAD_ZERO), ' ',
+  SCREEN_END
+};
+
+static const uint8_t HIGHSCORE_HINTS_FORMAT[] = {
+  SCREEN_MOVE(HIGHSCORE_Y + HIGHSCORE_LENGTH + 7, HIGHSCORE_X), SCREEN_STRING,
+  SCREEN_MOVE(HIGHSCORE_Y + HIGHSCORE_LENGTH + 8, HIGHSCORE_X), SCREEN_STRING,
+  SCREEN_END
+};
+
+static const uint8_t HIGHSCORE_EXIT_FORMAT[] = {
+  SCREEN_MOVE(HIGHSCORE_Y + HIGHSCORE_LENGTH + 7, HIGHSCORE_X), SCREEN_STRING,
+  SCREEN_END
+};
 
 // ----------------------------------------------------------------------------
 // Methods
@@ -73,14 +276,13 @@ static __inline void
 highscore_show_scoreboard (void);
 
 /**
- * Helper method to draw the line of a box.
+ * Callback method for the dynamic content of the screen templates.
  *
- * @param count The inner size of the box
- * @param edge The character to use for the edges
- * @param fill The character to use for the fill area
+ * @param slot The slot to send
+ * @param index The line of the repeated block
  */
-static __inline void
-highscore_send_boxline (uint8_t count, uint8_t edge, uint8_t fill);
+static void
+highscore_on_slot (uint8_t slot, uint8_t index);
 
 /**
  * Returns the next usable character for name entry.
@@ -104,18 +306,19 @@ highscore_prev_char (uint8_t c);
  * Callback method for a UART key press.
  *
  * @param buffer The buffer which holds the data
- * @return true if the CPU should be woken up
+ * @return true if the view has to be updated
  */
 static bool_t
-highscore_on_key (buffer_t *buffer);
+highscore_on_key (ring_t *buffer);
 
 /**
- * Callback method for a button press.
+ * Callback method for the button events.
+ * The character of the name entry can be scrolled by holding PB3 / PB4.
  *
- * @param button The button which was pressed
- * @return true if the CPU should be woken up
+ * @param event The button event
+ * @return true if the view has to be updated
  */
 static bool_t
-highscore_on_button (button_t button);
+highscore_on_button (const button_event_t *event);
 
 #endif // !__HIGHSCORE_P_H
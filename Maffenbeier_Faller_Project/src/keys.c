@@ -0,0 +1,138 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#include <stdint.h>
+
+#include "inc/def.h"
+#include "inc/config.h"
+
+#include "inc/keys.h"
+
+#include "keys_p.h"
+
+// ----------------------------------------------------------------------------
+// Fields
+// ----------------------------------------------------------------------------
+
+static keys_decoder_t keys;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+void
+keys_init (void)
+{
+  keys.state = KEYS_STATE_GROUND;
+  keys.report_v = 0;
+  keys.report_h = 0;
+}
+
+keycode_t
+keys_decode (uint8_t c)
+{
+  switch (keys.state)
+  {
+  case KEYS_STATE_ESCAPE:
+    if (c == '[')
+    {
+      keys.state = KEYS_STATE_CSI;
+      keys.params[0] = 0;
+      keys.params[1] = 0;
+      keys.param = 0;
+      return KEY_NONE;
+    }
+
+    if (c == 'O')
+    {
+      keys.state = KEYS_STATE_SS3;
+      return KEY_NONE;
+    }
+
+    if (c == KEY_ESCAPE)
+      return KEY_ESCAPE; // Wait for the next sequence
+
+    // Unknown sequence -> Decode the character on its own
+    keys.state = KEYS_STATE_GROUND;
+    break;
+  case KEYS_STATE_CSI:
+    if (c >= '0' && c <= '9')
+    {
+      uint16_t value = keys.params[keys.param] * 10 + (c - '0');
+      keys.params[keys.param] = (value > 0xFF) ? 0xFF : value;
+      return KEY_NONE;
+    }
+
+    if (c == ';')
+    {
+      if (keys.param < KEYS_PARAMS - 1)
+        ++keys.param;
+      return KEY_NONE;
+    }
+
+    if (c >= 0x40 && c <= 0x7E)
+    {
+      keys.state = KEYS_STATE_GROUND;
+      return keys_decode_csi(c);
+    }
+
+    // Ignore intermediate and private characters
+    if (c >= 0x20 && c < 0x40)
+      return KEY_NONE;
+
+    // A control character cancels the sequence
+    keys.state = KEYS_STATE_GROUND;
+    break;
+  case KEYS_STATE_SS3:
+    keys.state = KEYS_STATE_GROUND;
+    return keys_decode_final(c);
+  }
+
+  if (c == KEY_ESCAPE)
+  {
+    keys.state = KEYS_STATE_ESCAPE;
+    return KEY_NONE;
+  }
+
+  if (c == KEYS_DEL)
+    return KEY_DELETE;
+
+  // Only 7 bit characters are passed (NUL equals KEY_NONE)
+  return (c & 0x80) ? KEY_NONE : c;
+}
+
+void
+keys_get_cursor_report (uint8_t *v, uint8_t *h)
+{
+  *v = keys.report_v;
+  *h = keys.report_h;
+}
+
+static keycode_t
+keys_decode_csi (uint8_t c)
+{
+  if (c == '~')
+  {
+    uint8_t n = keys.params[0];
+    return (n < sizeof(KEYS_TILDE)) ? KEYS_TILDE[n] : KEY_NONE;
+  }
+
+  if (c == 'R' && keys.param != 0)
+  {
+    // ESC [ row ; column R
+    keys.report_v = keys.params[0];
+    keys.report_h = keys.params[1];
+    return KEY_CURSOR_REPORT;
+  }
+
+  return keys_decode_final(c);
+}
+
+static __inline keycode_t
+keys_decode_final (uint8_t c)
+{
+  if (c < 'A' || c > 'Z')
+    return KEY_NONE;
+
+  return KEYS_FINAL[c - 'A'];
+}
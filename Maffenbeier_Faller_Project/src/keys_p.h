@@ -0,0 +1,91 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#ifndef __KEYS_P_H
+#define __KEYS_P_H
+
+#include <stdint.h>
+
+#include "inc/def.h"
+#include "inc/keys.h"
+
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+// Decoder states
+#define KEYS_STATE_GROUND 0x00
+#define KEYS_STATE_ESCAPE 0x01 // ESC received
+#define KEYS_STATE_CSI 0x02 // ESC [ received, collecting parameters
+#define KEYS_STATE_SS3 0x03 // ESC O received
+
+// Number of stored CSI parameters (Further ones are combined into the last)
+#define KEYS_PARAMS 2
+
+#define KEYS_DEL 0x7F
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+typedef struct {
+  uint8_t state;
+
+  // Parameters of the current CSI sequence (Saturated at 255)
+  uint8_t params[KEYS_PARAMS];
+  uint8_t param;
+
+  // Last cursor position report
+  uint8_t report_v;
+  uint8_t report_h;
+} keys_decoder_t;
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+
+// Keys of the final characters 'A' to 'Z' of CSI and SS3 sequences
+static const keycode_t KEYS_FINAL['Z' - 'A' + 1] = {
+  KEY_UP, KEY_DOWN, KEY_RIGHT, KEY_LEFT, // A - D
+  KEY_NONE, KEY_END, KEY_NONE, KEY_HOME, // E - H
+  KEY_NONE, KEY_NONE, KEY_NONE, KEY_NONE, // I - L
+  KEY_NONE, KEY_NONE, KEY_NONE, // M - O
+  KEY_F1, KEY_F1 + 1, KEY_F1 + 2, KEY_F1 + 3, // P - S
+  KEY_NONE, KEY_NONE, KEY_NONE, KEY_NONE, // T - W
+  KEY_NONE, KEY_NONE, KEY_NONE // X - Z
+};
+
+// Keys of the sequences ESC [ n ~ with the parameter n
+static const keycode_t KEYS_TILDE[] = {
+  KEY_NONE, KEY_HOME, KEY_INSERT, KEY_REMOVE, // 0 - 3
+  KEY_END, KEY_PAGE_UP, KEY_PAGE_DOWN, KEY_HOME, // 4 - 7
+  KEY_END, KEY_NONE, KEY_NONE, KEY_F1, // 8 - 11
+  KEY_F1 + 1, KEY_F1 + 2, KEY_F1 + 3, KEY_F1 + 4, // 12 - 15
+  KEY_NONE, KEY_F1 + 5, KEY_F1 + 6, KEY_F1 + 7, // 16 - 19
+  KEY_F1 + 8, KEY_F1 + 9, KEY_NONE, KEY_F1 + 10, // 20 - 23
+  KEY_F12 // 24
+};
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+/**
+ * Returns the key of a completed CSI sequence.
+ *
+ * @param c The final character of the sequence
+ * @return The decoded key or KEY_NONE
+ */
+static keycode_t
+keys_decode_csi (uint8_t c);
+
+/**
+ * Returns the key of the final character of a CSI or SS3 sequence.
+ *
+ * @param c The final character of the sequence
+ * @return The decoded key or KEY_NONE
+ */
+static __inline keycode_t
+keys_decode_final (uint8_t c);
+
+#endif // !__KEYS_P_H
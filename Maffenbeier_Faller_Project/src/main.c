@@ -11,8 +11,10 @@
 #include "inc/def.h"
 #include "inc/config.h"
 
+#include "inc/clock.h"
 #include "inc/shift_register.h"
 #include "inc/uart.h"
+#include "inc/screen.h"
 #include "inc/tetris.h"
 #include "inc/timer.h"
 #include "inc/highscore.h"
@@ -26,6 +28,52 @@ __attribute__((always_inline))
 static __inline void
 setup (void);
 
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+
+static const char * const MAIN_TEXT[2] = {
+  "Welcome to Tetris.\r\n"
+#ifdef TETRIS_DEC_SCALE
+  "Please set the resolution to at least 44x80 chars!\r\n"
+#else
+  "Please set the resolution to at least 30x80 chars!\r\n"
+#endif
+  "\r\n"
+  "Press ENTER (5) to continue ...\r\n"
+  "Press H (6) to view the highscore table ...\r\n",
+  "Press B to switch to the fast baud rate ...\r\n"
+};
+
+// Arguments: Baud rate
+static const uint8_t MAIN_BAUD_FORMAT[] = {
+  '\r', '\n', 'B', 'a', 'u', 'd', ':', ' ',
+  SCREEN_NUMBER_LONG(0, UART_PAD_ZERO), '\r', '\n',
+  SCREEN_END
+};
+
+static const uint8_t MAIN_WELCOME_SCREEN[] = {
+  SCREEN_CLEAR,
+  SCREEN_TEXT(0),
+  SCREEN_END
+};
+
+static const screen_t main_welcome_screen = {
+  MAIN_WELCOME_SCREEN, MAIN_TEXT, 0
+};
+
+// Only shown if the fast baud rate can be generated with the current clock
+static const uint8_t MAIN_WELCOME_FAST_SCREEN[] = {
+  SCREEN_CLEAR,
+  SCREEN_TEXT(0),
+  SCREEN_TEXT(1),
+  SCREEN_END
+};
+
+static const screen_t main_welcome_fast_screen = {
+  MAIN_WELCOME_FAST_SCREEN, MAIN_TEXT, 0
+};
+
 // ----------------------------------------------------------------------------
 // Fields
 // ----------------------------------------------------------------------------
@@ -36,6 +84,9 @@ static uint8_t command_buffer[TETRIS_CMD_BUFFER_SIZE];
 static tetris_t tetris_buffer;
 static buttons_t button_buffer;
 
+// Set by TIMER_WELCOME if the welcome message has to be sent again
+static volatile bool_t welcome_pending;
+
 view_t view;
 
 int
@@ -47,11 +98,29 @@ main (void)
   setup();
 
   for (;;) {
-    // Go into low power mode 0
-    __bis_SR_register(CPUOFF);
+    // Go into low power mode 0 unless the UART requested to continue sending
+    // or input / the welcome message / a game frame is waiting (Checked with
+    // disabled interrupts so that no wake up gets lost)
+    __disable_interrupt();
+    if (uart_check_ready() || buttons_check_pending() || welcome_pending
+        || (view == VIEW_GAME && tetris_game_check_pending()))
+      __enable_interrupt();
+    else
+      __bis_SR_register(CPUOFF + GIE);
+
+    // Pass the input queued by the interrupts to the current view
+    uart_process();
+    buttons_process();
 
     restart:
     switch (view) {
+    case VIEW_WELCOME:
+      if (welcome_pending)
+      {
+        welcome_pending = 0x00;
+        main_send_welcome();
+      }
+      break;
     case VIEW_GAME:
       // Compute the next state and transmit
       tetris_game_process();
@@ -73,6 +142,9 @@ __attribute__((always_inline))
 static __inline void
 setup (void)
 {
+  // Select the DCO frequency before the peripherals derive their clocks
+  clock_init(CLOCK_PROFILE);
+
   // Initialize port 1 (set as input without pull-up / -down)
   // The UART module overwrites this setting for pin 1 & 2
   // The button module keeps this settings for pin 3 & 4
@@ -96,39 +168,44 @@ setup (void)
   buttons_init(&button_buffer);
 
   // Print a welcome message each second (Wait for terminal connection)
-  timer_init(TIMER_1);
-  timer_set_divider(TIMER_1, TIMER_DIVIDER_8);
-  timer_set_interval(TIMER_1, 0xF424); // 0.5 second
-  timer_set_callback(TIMER_1, &main_send_welcome);
-  timer_start(TIMER_1);
+  timer_init(TIMER_WELCOME);
+  timer_set_period(TIMER_WELCOME, 500); // 0.5 second
+  welcome_pending = 0x00;
+  view = VIEW_WELCOME;
+  timer_set_callback(TIMER_WELCOME, &main_on_welcome_timer);
+  timer_start(TIMER_WELCOME);
 
   uart_set_receive_callback(&main_uart_received);
   buttons_set_callback(&main_button_pressed);
+
+  // The welcome screen only uses PB5 and PB6 which wake up the CPU
+  buttons_set_mask(BUTTON_MASK_PORT);
 }
 
-static bool_t
+static void
 main_send_welcome (void)
 {
   uart_send_terminal_init();
-  uart_send_move_to(0, 1);
-  uart_send_cls();
-  uart_send_string("Welcome to Tetris.\r\n");
-  uart_send_string("Please set the resolution to at least 30x80 chars!\r\n");
-  uart_send_string("\r\n");
-  uart_send_string("Press ENTER (5) to continue ...\r\n");
-  uart_send_string("Press H (6) to view the highscore table ...\r\n");
-
-  // Don't wake the CPU
-  return 0;
+  screen_send(uart_check_fast() ? &main_welcome_fast_screen
+                                : &main_welcome_screen);
+}
+
+static bool_t
+main_on_welcome_timer (void)
+{
+  welcome_pending = 0x01;
+
+  // Send the message from the main loop
+  return 0x01;
 }
 
 static void
 main_view_game (void)
 {
-  timer_stop(TIMER_1);
+  timer_stop(TIMER_WELCOME);
 
-  // Seed the RNG with current timer value
-  srand(timer_get_value(TIMER_2));
+  // Seed the RNG with the current counter value
+  srand(timer_get_ticks());
 
   // Initialize the game
   tetris_game_init(&tetris_buffer, command_buffer, TETRIS_CMD_BUFFER_SIZE);
@@ -139,28 +216,40 @@ main_view_game (void)
 
   tetris_game_start();
 
-  // Wake up CPU to send the initial game field
+  // Send the initial game field
   view = VIEW_GAME;
 }
 
 static void
 main_view_highscore (void)
 {
-  timer_stop(TIMER_1);
+  timer_stop(TIMER_WELCOME);
 
   // Initialize highscore view
   highscore_init(HIGHSCORE_SHOW,
                  (highscore_state_t*) &tetris_buffer.game_field);
 
-  // Wake up CPU to load the highscore list
+  // Load the highscore list
   view = VIEW_HIGHSCORE;
 }
 
+static void
+main_switch_baud (void)
+{
+  // The announcement is still sent with the old baud rate (Only the main
+  // loop queues data, so nothing else is sent before the switch)
+  if (uart_check_fast())
+  {
+    screen_printf(MAIN_BAUD_FORMAT, UART_BAUD_FAST);
+    uart_set_fast(0x01);
+  }
+}
+
 static bool_t
-main_uart_received (buffer_t *buffer)
+main_uart_received (ring_t *buffer)
 {
-  while (!buffer_is_empty(buffer)) {
-    switch(buffer_dequeue(buffer)) {
+  while (!ring_is_empty(buffer)) {
+    switch(ring_get(buffer)) {
     case KEY_ENTER:
     case 'T': // Tetris
     case 't':
@@ -170,6 +259,10 @@ main_uart_received (buffer_t *buffer)
     case 'h':
       main_view_highscore();
       return 0x01;
+    case 'B': // Fast baud rate
+    case 'b':
+      main_switch_baud();
+      break;
     default:
       break;
     }
@@ -180,9 +273,12 @@ main_uart_received (buffer_t *buffer)
 }
 
 static bool_t
-main_button_pressed (button_t button)
+main_button_pressed (const button_event_t *event)
 {
-  switch (button)
+  if (event->type != BUTTON_PRESS)
+    return 0x00;
+
+  switch (event->button)
   {
   case BUTTON_5:
     main_view_game();
@@ -0,0 +1,204 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#include "inc/def.h"
+#include "inc/config.h"
+
+#include "inc/uart.h"
+#include "inc/screen.h"
+
+#include "screen_p.h"
+
+// ----------------------------------------------------------------------------
+// Fields
+// ----------------------------------------------------------------------------
+
+static screen_job_t job;
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+void
+screen_send (const screen_t *screen)
+{
+  screen_start(screen);
+  screen_resume(0);
+}
+
+void
+screen_printf (const uint8_t *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+
+  for (;;)
+  {
+    uint8_t c = *format++;
+    switch (c)
+    {
+    case SCREEN_OP_END:
+      va_end(args);
+      return;
+    case SCREEN_OP_MOVE:
+      uart_send_move_to(format[0], format[1]);
+      format += 2;
+      break;
+    case SCREEN_OP_FILL:
+      uart_send_repeat(format[1], format[0]);
+      format += 2;
+      break;
+    case SCREEN_OP_CLEAR:
+      uart_send_move_to(0, 1);
+      uart_send_cls();
+      break;
+    case SCREEN_OP_ARG:
+      {
+        uint8_t type = format[0];
+        uint8_t width = format[1];
+        format += 2;
+
+        switch (type & SCREEN_ARG_TYPE)
+        {
+        case SCREEN_ARG_NUMBER:
+          uart_send_number(va_arg(args, unsigned int), width,
+                           (uart_pad_t) (type & ~SCREEN_ARG_TYPE));
+          break;
+        case SCREEN_ARG_NUMBER_LONG:
+          uart_send_number(va_arg(args, uint32_t), width,
+                           (uart_pad_t) (type & ~SCREEN_ARG_TYPE));
+          break;
+        case SCREEN_ARG_STRING:
+          uart_send_string(va_arg(args, const char *));
+          break;
+        case SCREEN_ARG_BYTES:
+          {
+            const uint8_t *data = va_arg(args, const uint8_t *);
+            uart_send_bytes(data, va_arg(args, unsigned int));
+            break;
+          }
+        case SCREEN_ARG_ROW:
+          uart_send_move_to(va_arg(args, unsigned int), width);
+          break;
+        }
+        break;
+      }
+    default:
+      {
+        // Send the following characters at once
+        const uint8_t *start = format - 1;
+        uint8_t length = 1;
+        while (*format > SCREEN_OP_LAST && length != 0xFF)
+        {
+          ++format;
+          ++length;
+        }
+
+        uart_send_bytes(start, length);
+        break;
+      }
+    }
+  }
+}
+
+void
+screen_start (const screen_t *screen)
+{
+  job.screen = screen;
+  job.p = screen->code;
+
+  job.loop_start = 0;
+  job.loop_count = 0;
+  job.loop_index = 0;
+  job.loop_lines = 0;
+  job.loop_v = 0;
+  job.loop_h = 0;
+}
+
+bool_t
+screen_resume (uint8_t reserve)
+{
+  for (;;)
+  {
+    if (reserve != 0 && !uart_reserve(reserve))
+      return 0x00;
+
+    uint8_t c = *job.p++;
+    switch (c)
+    {
+    case SCREEN_OP_END:
+      // Stay at the end of the template
+      --job.p;
+      return 0x01;
+    case SCREEN_OP_MOVE:
+      uart_send_move_to(job.p[0], job.p[1]);
+      job.p += 2;
+      break;
+    case SCREEN_OP_FILL:
+      uart_send_repeat(job.p[1], job.p[0]);
+      job.p += 2;
+      break;
+    case SCREEN_OP_TEXT:
+      uart_send_string(job.screen->text[*job.p++]);
+      break;
+    case SCREEN_OP_SLOT:
+      job.screen->slot(*job.p++, job.loop_index);
+      break;
+    case SCREEN_OP_CLEAR:
+      uart_send_move_to(0, 1);
+      uart_send_cls();
+      break;
+    case SCREEN_OP_REPEAT:
+      job.loop_count = *job.p++;
+      job.loop_lines = 0;
+      job.loop_index = 0;
+      job.loop_start = job.p;
+      break;
+    case SCREEN_OP_LINES:
+      job.loop_count = job.p[0];
+      job.loop_v = job.p[1];
+      job.loop_h = job.p[2];
+      job.p += 3;
+
+      job.loop_lines = 1;
+      job.loop_index = 0;
+      job.loop_start = job.p;
+
+      uart_send_move_to(job.loop_v, job.loop_h);
+      break;
+    case SCREEN_OP_ARG:
+      // Arguments are only passed to screen_printf
+      job.p += 2;
+      break;
+    case SCREEN_OP_LOOP:
+      if (++job.loop_index >= job.loop_count)
+      {
+        job.loop_index = 0;
+        break;
+      }
+
+      job.p = job.loop_start;
+      if (job.loop_lines)
+        uart_send_move_to(job.loop_v + job.loop_index, job.loop_h);
+      break;
+    default:
+      {
+        // Send the following characters at once (Within the reserve)
+        const uint8_t *start = job.p - 1;
+        uint8_t length = 1;
+        while (*job.p > SCREEN_OP_LAST && length != reserve
+               && length != 0xFF)
+        {
+          ++job.p;
+          ++length;
+        }
+
+        uart_send_bytes(start, length);
+        break;
+      }
+    }
+  }
+}
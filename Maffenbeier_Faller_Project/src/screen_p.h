@@ -0,0 +1,32 @@
+// (c) Tobias Faller 2017
+// (c) Tim Maffenbeier 2017
+
+#ifndef __SCREEN_P_H
+#define __SCREEN_P_H
+
+#include <stdint.h>
+
+#include "inc/def.h"
+#include "inc/screen.h"
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * Position of the interpreter in the template which is currently sent.
+ */
+typedef struct {
+  const screen_t *screen;
+  const uint8_t *p;
+
+  // State of the current repeated block
+  const uint8_t *loop_start;
+  uint8_t loop_count;
+  uint8_t loop_index;
+  bool_t loop_lines;
+  uint8_t loop_v;
+  uint8_t loop_h;
+} screen_job_t;
+
+#endif // !__SCREEN_P_H
@@ -11,6 +11,9 @@
 
 #include "shift_register_p.h"
 
+// State of the LEDs which is shifted out with every exchange
+static uint8_t shift_register_leds;
+
 __inline void
 shift_register_init (void)
 {
@@ -22,53 +25,35 @@ shift_register_init (void)
   P2OUT = 0; // Reset shift register
 
   // Enable shift register
-  P2OUT = BIT5;
+  P2OUT = SHIFT_REGISTER_IDLE;
+  shift_register_leds = 0;
 }
 
 __inline void
 shift_register_set_leds (uint8_t state)
 {
-  uint8_t i;
-
-  // Enable shifting for shift register 2
-  P2OUT = (P2OUT & ~0x03) | BIT0;
-
-  for (i = 0; i < 4; i++) { // Write each LED
-    if ((state >> i) & 0x01) {
-      P2OUT |= BIT6; // Set LED to high
-    } else {
-      P2OUT &= ~BIT6; // Set LED to low
-    }
-
-    shift_register_clock();
-  }
-
-  // Disable shift register 2
-  P2OUT &= ~0x03;
+  shift_register_exchange(state);
 }
 
 __inline uint8_t
 shift_register_get_buttons (void)
 {
-  uint8_t i;
-  uint8_t button_state = 0;
-
-  // Load button data into shift register 1
-  P2OUT |= 0x0C;
-  shift_register_clock();
-
-  // Enable shifting for shift register 1
-  P2OUT &= ~BIT3;
-
-  for (i = 4; i > 0; i--) {
-    if (i != 4)
-      shift_register_clock(); // Read next value
-
-    button_state |= ((P2IN & BIT7) >> (3 + i));
-  }
-
-  // Disable shift register 1
-  P2OUT &= ~0x0C;
+  return shift_register_exchange(shift_register_leds);
+}
 
-  return button_state;
+uint8_t
+shift_register_exchange (uint8_t leds)
+{
+  uint8_t buttons;
+  shift_register_leds = leds;
+
+  // The first pulse loads the buttons into SR1 which are shifted out in the
+  // order PB4 to PB1 while the LEDs are shifted into SR2
+  buttons = shift_register_pulse(SHIFT_REGISTER_LOAD_VALUE(leds, 0)) >> 4;
+  buttons |= shift_register_pulse(SHIFT_REGISTER_SHIFT_VALUE(leds, 1)) >> 5;
+  buttons |= shift_register_pulse(SHIFT_REGISTER_SHIFT_VALUE(leds, 2)) >> 6;
+  buttons |= shift_register_pulse(SHIFT_REGISTER_SHIFT_VALUE(leds, 3)) >> 7;
+
+  P2OUT = SHIFT_REGISTER_IDLE;
+  return buttons;
 }
@@ -4,28 +4,59 @@
 #ifndef __SHIFT_REGISTER_P_H
 #define __SHIFT_REGISTER_P_H
 
+// ----------------------------------------------------------------------------
+// Definitions
+// ----------------------------------------------------------------------------
+
+// Port 2 lines of both shift registers
+#define SHIFT_REGISTER_SR2_SHIFT BIT0 // S0 of SR2 (Shift right)
+#define SHIFT_REGISTER_SR1_SHIFT BIT2 // S0 of SR1 (Shift right)
+#define SHIFT_REGISTER_SR1_LOAD (BIT2 | BIT3) // S0 and S1 of SR1 (Load)
+#define SHIFT_REGISTER_CLOCK BIT4 // Shared CK
+#define SHIFT_REGISTER_CLEAR BIT5 // Shared /CLR (Kept high)
+#define SHIFT_REGISTER_DATA BIT6 // Serial input of SR2
+#define SHIFT_REGISTER_QD BIT7 // Output QD of SR1
+
+// Port value of the idle shift registers (Both hold their state)
+#define SHIFT_REGISTER_IDLE SHIFT_REGISTER_CLEAR
+
+// Port value which shifts bit n of the LED state into SR2 while SR1 either
+// loads the buttons (First pulse) or shifts them out
+#define SHIFT_REGISTER_LOAD_VALUE(leds, n) (SHIFT_REGISTER_CLEAR \
+    | SHIFT_REGISTER_SR2_SHIFT | SHIFT_REGISTER_SR1_LOAD \
+    | ((((leds) >> (n)) & 0x01) ? SHIFT_REGISTER_DATA : 0))
+#define SHIFT_REGISTER_SHIFT_VALUE(leds, n) (SHIFT_REGISTER_CLEAR \
+    | SHIFT_REGISTER_SR2_SHIFT | SHIFT_REGISTER_SR1_SHIFT \
+    | ((((leds) >> (n)) & 0x01) ? SHIFT_REGISTER_DATA : 0))
+
 // ----------------------------------------------------------------------------
 // Methods
 // ----------------------------------------------------------------------------
 
 /**
- * Applies one clock pulse to both shift registers.
+ * Applies one clock pulse to both shift registers with the mode and data
+ * lines set to the port value. Returns the output QD of SR1 after the pulse.
+ *
+ * @param value The port value without the clock line
+ * @return SHIFT_REGISTER_QD if the output is high, otherwise 0
  */
 __attribute__((always_inline))
-__inline void
-shift_register_clock (void);
+__inline uint8_t
+shift_register_pulse (uint8_t value);
 
 // ----------------------------------------------------------------------------
 // Implementations
 // ----------------------------------------------------------------------------
 
 __attribute__((always_inline))
-__inline void
-shift_register_clock (void)
+__inline uint8_t
+shift_register_pulse (uint8_t value)
 {
-  // Creates one clock pulse
-  P2OUT |= BIT4; // Set clock to high
-  P2OUT &= ~BIT4; // Set clock to low
+  // Both registers take over the data on the rising edge
+  P2OUT = value;
+  P2OUT = value | SHIFT_REGISTER_CLOCK;
+
+  return P2IN & SHIFT_REGISTER_QD;
 }
 
 #endif // !__SHIFT_REGISTER_P_H
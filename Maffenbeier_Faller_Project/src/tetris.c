@@ -12,6 +12,7 @@
 #include "inc/timer.h"
 #include "inc/util.h"
 #include "inc/uart.h"
+#include "inc/screen.h"
 #include "inc/highscore.h"
 #include "inc/buttons.h"
 
@@ -19,6 +20,16 @@
 
 static tetris_t *tetris_inst;
 
+#ifdef TETRIS_DEC_SCALE
+static const screen_t tetris_dec_screen = {
+  TETRIS_DEC_SCREEN, 0, 0
+};
+#endif
+
+static const screen_t tetris_screen = {
+  TETRIS_SCREEN, TETRIS_TEXT, &tetris_on_slot
+};
+
 // --- Game -------------------------------------------------------------------
 
 void
@@ -43,12 +54,22 @@ tetris_game_init (tetris_t *tetris, uint8_t *cmd_buffer,
   tetris->score_factor = 0;
   tetris->t_spin = 0;
 
-  tetris->command_buffer.buffer = cmd_buffer;
-  tetris->command_buffer.buffer_size = cmd_buffer_size;
-  tetris->command_buffer.start = 0;
-  tetris->command_buffer.fill = 0;
 
-  memset(&tetris->game_field, TETRIS_FIELD_EMPTY, sizeof(field_t));
+  ring_init(&tetris->command_buffer, cmd_buffer, cmd_buffer_size);
+  tetris->fall = 0;
+  tetris->frame_pending = 0;
+
+  for (uint8_t y = TETRIS_HEIGHT; y-- > 0;)
+  {
+    tetris->game_field.rows[y] = TETRIS_ROW_EMPTY;
+    tetris->game_field.types[y] = TETRIS_TYPES_EMPTY;
+  }
+
+  // Send the complete screen with the first update
+  tetris->redraw = TETRIS_REDRAW_START;
+  tetris->dirty = 0;
+  tetris->shown_score = 0;
+  tetris->preview = TETROMINO_NONE;
 
   tetris_game_new_tetromino();
 }
@@ -56,14 +77,36 @@ tetris_game_init (tetris_t *tetris, uint8_t *cmd_buffer,
 void
 tetris_game_start (void)
 {
-  timer_init(TIMER_1);
-  timer_set_divider(TIMER_1, TIMER_DIVIDER_8);
-  timer_set_interval(TIMER_1, 0xF424); // 0.5 second (scaled down to 1.5s)
-  timer_set_callback(TIMER_1, &tetris_on_timer);
-  timer_start(TIMER_1);
+  timer_init(TIMER_GAME);
+  timer_set_period(TIMER_GAME, TETRIS_FALL_PERIOD); // (scaled down to 1.5s)
+  timer_set_callback(TIMER_GAME, &tetris_on_timer);
+  timer_start(TIMER_GAME);
+
+  timer_init(TIMER_FRAME);
+  timer_set_period(TIMER_FRAME, TETRIS_FRAME_INTERVAL);
+  timer_set_callback(TIMER_FRAME, &tetris_on_frame_timer);
 
   uart_set_receive_callback(&tetris_on_key);
   buttons_set_callback(&tetris_on_button);
+  buttons_set_mask(BUTTON_MASK_ALL);
+
+  // Shift and soft drop with delayed auto-repeat
+  buttons_set_repeat(BUTTON_MASK(BUTTON_3) | BUTTON_MASK(BUTTON_4)
+                     | BUTTON_MASK(BUTTON_6));
+}
+
+void
+tetris_game_redraw (void)
+{
+  // The terminal may have lost its content, so nothing is derived from it
+  uart_invalidate_screen();
+  tetris_inst->redraw = TETRIS_REDRAW_START;
+}
+
+bool_t
+tetris_game_check_pending (void)
+{
+  return tetris_inst->frame_pending && !timer_is_running(TIMER_FRAME);
 }
 
 void
@@ -73,6 +116,13 @@ tetris_game_process (void)
   {
     field_t *field = tetris_field_get_current(tetris_inst);
 
+    // The terminal shows the tetromino at this location unless it is damaged
+    tetromino_t tetro = tetris_inst->tetro;
+    uint8_t tetro_x = tetris_inst->tetro_x;
+    uint8_t tetro_y = tetris_inst->tetro_y;
+    uint8_t tetro_rot = tetris_inst->tetro_rot;
+    bool_t locked = 0x00;
+
     // Clear old tetromino position
     tetris_game_place_tetromino(field, tetris_inst->tetro,
                                 tetris_inst->tetro_x,
@@ -80,25 +130,37 @@ tetris_game_process (void)
                                 tetris_inst->tetro_rot,
                                 TETRIS_FIELD_EMPTY);
 
-    while (!buffer_is_empty(&tetris_inst->command_buffer))
+    // The timer moves the tetromino down after the queued commands unless
+    // they already did
+    while (!ring_is_empty(&tetris_inst->command_buffer) || tetris_inst->fall)
     {
-      switch ((tetris_command_t) buffer_dequeue(&tetris_inst->command_buffer))
+      tetris_command_t command = COMMAND_DOWN;
+      if (!ring_is_empty(&tetris_inst->command_buffer))
+        command = (tetris_command_t) ring_get(&tetris_inst->command_buffer);
+
+      switch (command)
       {
       case COMMAND_DOWN:
-        timer_reset(TIMER_1);
+        tetris_inst->fall = 0;
+        timer_reset(TIMER_GAME);
         tetris_inst->timer_divider = 0;
 
-        if (tetris_game_down(tetris_inst, field) == 0)
+        switch (tetris_game_down(tetris_inst, field))
         {
+        case 0:
           tetris_on_game_over();
           return;
+        case 2:
+          locked = 0x01;
+          break;
         }
         break;
       case COMMAND_DROP:
         {
           uint8_t result;
 
-          timer_reset(TIMER_1);
+          tetris_inst->fall = 0;
+          timer_reset(TIMER_GAME);
           tetris_inst->timer_divider = 0;
 
           do
@@ -111,6 +173,8 @@ tetris_game_process (void)
             tetris_on_game_over();
             return;
           }
+
+          locked = 0x01;
           break;
         }
       case COMMAND_LEFT:
@@ -130,10 +194,31 @@ tetris_game_process (void)
                                 tetris_inst->tetro_y,
                                 tetris_inst->tetro_rot,
                                 tetris_inst->tetro);
+    tetris_game_damage_move(tetro, tetro_x, tetro_y, tetro_rot, locked);
+
+    // Hold the frame back until the frame interval passed, the frame timer
+    // wakes up the CPU to send the latest state then
+    if (timer_is_running(TIMER_FRAME))
+    {
+      tetris_inst->frame_pending = 0x01;
+      break;
+    }
 
-    tetris_game_send(tetris_inst);
+    tetris_inst->frame_pending = 0x00;
 
-    if (buffer_is_empty(&tetris_inst->command_buffer))
+    // Don't queue a frame behind the last one, the latest state is sent as
+    // soon as the transmit buffer drained
+    if (!uart_reserve(TETRIS_FRAME_SIZE))
+      break;
+
+    // Stop if the UART can't take the complete update, it is continued with
+    // the latest state as soon as there is space in the transmit buffer
+    if (!tetris_game_send(tetris_inst))
+      break;
+
+    timer_start_once(TIMER_FRAME);
+
+    if (ring_is_empty(&tetris_inst->command_buffer) && !tetris_inst->fall)
       break;
   }
 }
@@ -143,114 +228,74 @@ tetris_game_process (void)
 static bool_t
 tetris_on_timer (void)
 {
-  // Enable reentrant interrupts for UART
-  __enable_interrupt();
-
   if (++tetris_inst->timer_divider < 2)
     return 0;
   else
     tetris_inst->timer_divider = 0;
 
-  for (uint8_t i = buffer_get_fill(&tetris_inst->command_buffer); i-- > 0;)
-  {
-    uint8_t *command = buffer_get_at(&tetris_inst->command_buffer, i);
-    if (*((tetris_command_t*)command) == COMMAND_DOWN
-        || *((tetris_command_t*)command) == COMMAND_DROP) {
-      return 0; // Down command is already queued
-    }
-  }
-
-  if (!buffer_is_full(&tetris_inst->command_buffer))
-    buffer_enqueue(&tetris_inst->command_buffer, COMMAND_DOWN);
+  // The command queue belongs to the main loop, only flag the fall
+  tetris_inst->fall = 0x01;
 
   // Wake up CPU to update the game field
   return 0x01;
 }
 
 static bool_t
-tetris_on_key (buffer_t *buffer)
+tetris_on_frame_timer (void)
+{
+  // Only wake up the CPU if a frame was held back
+  return tetris_inst->frame_pending;
+}
+
+static bool_t
+tetris_on_key (ring_t *buffer)
 {
   bool_t wake_cpu = 0;
-  for (;;)
+  while (!ring_is_empty(buffer))
   {
-    uint8_t fill = buffer_get_fill(buffer);
-    if (fill == 0)
-      break;
-
-    uint8_t *first_char = buffer_get_at(buffer, 0);
-    if (*first_char != KEY_ESCAPE)
-    {
-      // Remove character
-      buffer_dequeue(buffer);
-
-      // No escape sequence
-      switch (*first_char)
-      {
-      case KEY_SPACE:
-        tetris_on_command(COMMAND_DROP);
-        wake_cpu = 1;
-        break;
-      default: // Ignore
-        break;
-      }
-
-      continue;
-    }
-    else if (fill >= 2)
+    switch (ring_get(buffer))
     {
-      uint8_t *second_char = buffer_get_at(buffer, 1);
-      if (*second_char != '[') {
-        // Remove characters
-        buffer_dequeue(buffer);
-        buffer_dequeue(buffer);
-
-        return wake_cpu;
-      }
-
-      if (fill < 3)
-        return wake_cpu;
-
-      // Remove characters 'ESC' '['
-      buffer_dequeue(buffer);
-      buffer_dequeue(buffer);
-
-      // Arrow key escape sequence
-      switch (buffer_dequeue(buffer))
-      {
-      case KEY_LEFT:
-        tetris_on_command(COMMAND_LEFT);
-        wake_cpu = 1;
-        break;
-      case KEY_RIGHT:
-        tetris_on_command(COMMAND_RIGHT);
-        wake_cpu = 1;
-        break;
-      case KEY_UP:
-        tetris_on_command(COMMAND_ROTATE);
-        wake_cpu = 1;
-        break;
-      case KEY_DOWN:
-        tetris_on_command(COMMAND_DOWN);
-        wake_cpu = 1;
-        break;
-      default: // Ignore
-        break;
-      }
-
-      continue; // Process next characters
-    } else {
-      return wake_cpu;
+    case KEY_SPACE:
+      tetris_on_command(COMMAND_DROP);
+      wake_cpu = 1;
+      break;
+    case 'R': // Redraw
+    case 'r':
+      tetris_game_redraw();
+      wake_cpu = 1;
+      break;
+    case KEY_LEFT:
+      tetris_on_command(COMMAND_LEFT);
+      wake_cpu = 1;
+      break;
+    case KEY_RIGHT:
+      tetris_on_command(COMMAND_RIGHT);
+      wake_cpu = 1;
+      break;
+    case KEY_UP:
+      tetris_on_command(COMMAND_ROTATE);
+      wake_cpu = 1;
+      break;
+    case KEY_DOWN:
+      tetris_on_command(COMMAND_DOWN);
+      wake_cpu = 1;
+      break;
+    default: // Ignore
+      break;
     }
   }
 
-  // Wake up CPU to update the game field
+  // Update the game field
   return wake_cpu;
 }
 
 static bool_t
-tetris_on_button (button_t button)
+tetris_on_button (const button_event_t *event)
 {
-  switch (button)
+  if (event->type != BUTTON_PRESS && event->type != BUTTON_REPEAT)
+    return 0x00;
+
+  switch (event->button)
   {
   case BUTTON_1: // Drop till floor
     tetris_on_command(COMMAND_DROP);
@@ -272,23 +317,24 @@ tetris_on_button (button_t button)
     break;
   }
 
-  // Wake up CPU to update the game field
+  // Update the game field
   return 0x01;
 }
 
 static void
 tetris_on_command (tetris_command_t command)
 {
-  if (buffer_is_full(&tetris_inst->command_buffer))
+  if (ring_is_full(&tetris_inst->command_buffer))
     return;
 
-  buffer_enqueue(&tetris_inst->command_buffer, command);
+  ring_put(&tetris_inst->command_buffer, command);
 }
 
 static void
 tetris_on_game_over (void)
 {
-  timer_stop(TIMER_1);
+  timer_stop(TIMER_GAME);
+  timer_stop(TIMER_FRAME);
   uart_set_receive_callback(0);
 
   // Re-use the main memory area for temporary storage
@@ -349,12 +395,52 @@ tetris_game_new_tetromino (void)
   tetris_inst->tetro_y = TETROMINO_INIT_POS[tetris_inst->tetro][1];
 }
 
+static void
+tetris_game_damage_move (tetromino_t tetromino, uint8_t x, uint8_t y,
+                         uint8_t rotation, bool_t locked)
+{
+#ifdef TETRIS_DELTA_RENDERING
+  int8_t tops[2] = {
+    (int8_t) y + TETROMINO_SHAPE[tetromino][rotation].top,
+    (int8_t) tetris_inst->tetro_y
+        + TETROMINO_SHAPE[tetris_inst->tetro][tetris_inst->tetro_rot].top
+  };
+
+  // Shared rows of both locations are marked twice with the same columns
+  for (uint8_t i = 0; i < 2; ++i)
+  {
+    for (int8_t fy = tops[i]; fy < tops[i] + 4; ++fy)
+    {
+      field_row_t before = tetris_shape_row_at(tetromino, x, y, rotation, fy);
+      field_row_t after = tetris_shape_row_at(tetris_inst->tetro,
+                                              tetris_inst->tetro_x,
+                                              tetris_inst->tetro_y,
+                                              tetris_inst->tetro_rot, fy);
+
+      // The cells of an unchanged tetromino show the same character
+      tetris_field_damage((uint8_t) fy,
+                          locked ? (before | after) : (before ^ after));
+    }
+  }
+#else
+  (void) tetromino;
+  (void) x;
+  (void) y;
+  (void) rotation;
+  (void) locked;
+#endif
+}
+
 static __inline void
 tetris_game_speedup (void)
 {
-  // Take 7 / 8 of the original interval
-  uint16_t interval = timer_get_interval(TIMER_1);
-  timer_set_interval(TIMER_1, interval - (interval >> 3));
+  // Take 7 / 8 of the period per level, computed from the start as the timer
+  // only keeps whole slots
+  uint16_t period = TETRIS_FALL_PERIOD;
+  for (uint16_t level = tetris_inst->level; level-- > 0 && period >= 8;)
+    period -= period >> 3;
+
+  timer_set_period(TIMER_GAME, period);
 }
 
 static __inline uint8_t
@@ -373,17 +459,35 @@ tetris_game_down (tetris_t *tetris, field_t *field)
       return 0; // Tetromino is out of bounds -> game over
     }
 
-    field_item_t *item = tetris_field_item_get_at(field, 0, 0);
-    for (uint8_t i = TETRIS_WIDTH * TETRIS_TOP_HIDDEN; i-- >0; )
+    for (uint8_t i = TETRIS_TOP_HIDDEN; i-- > 0;)
     {
-      if(!tetris_field_item_is_empty(item++))
+      if (field->rows[i] != TETRIS_ROW_EMPTY)
         return 0; // Top field was used -> game over
     }
 
+    // Get the rows spanned by the placed tetromino
+    const tetromino_shape_t *shape
+        = &TETROMINO_SHAPE[tetris->tetro][tetris->tetro_rot];
+    int8_t top = (int8_t) tetris->tetro_y + shape->top;
+    int8_t bottom = top;
+    while (bottom < top + 3 && shape->rows[bottom - top + 1] != 0)
+      bottom++;
+
+    // The tetromino may be locked at a location which was never shown
+    for (int8_t fy = top; fy <= bottom; ++fy)
+    {
+      tetris_field_damage((uint8_t) fy, tetris_shape_row_to_field(
+          shape->rows[fy - top], tetris->tetro_x));
+    }
+
+    if (top < 0)
+      top = 0;
+
     // Choose next tetromino
     tetris_game_new_tetromino();
 
-    uint8_t cleared = tetris_field_clear_full_lines(field);
+    uint8_t cleared = tetris_field_clear_full_lines(field, (uint8_t) top,
+                                                    (uint8_t) bottom);
     tetris_game_update_score(tetris, cleared, tetris->t_spin);
 
     return 2;
@@ -395,48 +499,50 @@ tetris_game_down (tetris_t *tetris, field_t *field)
 }
 
 static __inline uint8_t
-tetris_field_clear_full_lines (field_t *field)
+tetris_field_clear_full_lines (field_t *field, uint8_t top, uint8_t bottom)
 {
   uint8_t lines_cleared = 0;
+  uint8_t cleared_rows = 0;
 
-  // Update from bottom up
-  for (findex_t y = TETRIS_HEIGHT; y-- > 0;)
+  // Find the full rows (Only rows of the last tetromino can be full)
+  for (uint8_t y = bottom + 1; y-- > top;)
   {
-    // Check each item in row
-    for (findex_t x = TETRIS_WIDTH; x-- > 0;)
+    cleared_rows <<= 1;
+    if (field->rows[y] == TETRIS_ROW_FULL)
     {
-      field_item_t *item = tetris_field_item_get_at(field, x, y);
-      if (tetris_field_item_is_empty(item))
-        goto next_row;
+      cleared_rows |= 0x01;
+      lines_cleared++;
     }
+  }
 
-    lines_cleared++;
-
-    // Row is full -> drop rows from bottom to top
-    for (findex_t dy = y + 1; dy > 0;)
-    {
-      dy--;
+  if (lines_cleared == 0)
+    return 0;
 
-      for (findex_t x = TETRIS_WIDTH; x-- > 0;)
-      {
-        findex_t index = tetris_field_item_get_index(x, dy);
+  // Compact the remaining rows in one pass from bottom to top
+  int8_t dst = bottom;
+  int8_t src = bottom;
+  for (; src >= 0; src--)
+  {
+    if (src >= top && ((cleared_rows >> (src - top)) & 0x01))
+      continue; // Drop this row
 
-        if (dy == 0) // Clear top row
-        {
-          tetris_field_item_set(field, index, TETRIS_FIELD_EMPTY);
-        }
-        else
-        {
-          field_item_t *upper_item = tetris_field_item_get_at(field, x, dy - 1);
-          tetris_field_item_set(field, index, *upper_item);
-        }
-      }
-    }
+    if (src < top && field->rows[src] == TETRIS_ROW_EMPTY)
+      break; // All rows above are empty too
 
-    y++; // Re-check this row
+    tetris_field_damage(dst, tetris_field_changed_columns(field->types[dst]
+                                                          ^ field->types[src]));
+    field->rows[dst] = field->rows[src];
+    field->types[dst] = field->types[src];
+    dst--;
+  }
 
-next_row:
-    ;
+  // Clear the rows which were moved down
+  for (; dst > src; dst--)
+  {
+    tetris_field_damage(dst, tetris_field_changed_columns(field->types[dst]
+                                                          ^ TETRIS_TYPES_EMPTY));
+    field->rows[dst] = TETRIS_ROW_EMPTY;
+    field->types[dst] = TETRIS_TYPES_EMPTY;
   }
 
   return lines_cleared;
@@ -480,34 +586,32 @@ tetris_game_update_score (tetris_t *tetris, uint8_t cleared, bool_t t_spin)
 
   // Get result using pre-computed table
   tetris->score += points;
+  tetris->dirty |= TETRIS_DIRTY_SCORE;
 
   // Increase score factor
   if (tetris->score_factor < 19)
     tetris->score_factor++;
 
   if (tetris->level != last_level)
+  {
+    tetris->dirty |= TETRIS_DIRTY_LEVEL;
     tetris_game_speedup();
+  }
 }
 
 static bool_t
 tetris_game_check_collision (field_t *field, tetromino_t tetromino,
                              uint8_t x, uint8_t y, uint8_t rotation)
 {
-  const int8_t *tetroimino_fields = TETROMINO[tetromino] + (rotation << 3);
-  for (uint8_t i = 4; i-- > 0;)
+  const tetromino_shape_t *shape = &TETROMINO_SHAPE[tetromino][rotation];
+  int8_t fy = (int8_t) y + shape->top;
+  for (uint8_t i = 0; i < 4; ++i, ++fy)
   {
-    int8_t fx = (int8_t) x + *(tetroimino_fields++);
-    int8_t fy = (int8_t) y + *(tetroimino_fields++);
-
-    if(!tetris_check_bounds(fx, fy))
-      return 1;
-
-    if (fy < 0) // Ignore if higher than field
-      continue;
+    uint8_t mask = shape->rows[i];
+    if (mask == 0)
+      break;
 
-    field_item_t *item = tetris_field_item_get_at(field, (uint8_t) fx,
-                                                  (uint8_t) fy);
-    if (!tetris_field_item_is_empty(item))
+    if (tetris_field_row_get(field, fy) & tetris_shape_row_to_field(mask, x))
       return 1;
   }
 
@@ -519,23 +623,59 @@ tetris_game_place_tetromino (field_t *field, tetromino_t tetromino,
                              uint8_t x, uint8_t y, uint8_t rotation,
                              uint8_t value)
 {
-  const int8_t *tetroimino_fields = TETROMINO[tetromino] + (rotation << 3);
-  for (uint8_t i = 4; i-- > 0;)
+  bool_t in_bounds = 1;
+  const tetromino_shape_t *shape = &TETROMINO_SHAPE[tetromino][rotation];
+  int8_t fy = (int8_t) y + shape->top;
+  for (uint8_t i = 0; i < 4; ++i, ++fy)
   {
-    int8_t fx = (int8_t) x + *(tetroimino_fields++);
-    int8_t fy = (int8_t) y + *(tetroimino_fields++);
+    uint8_t mask = shape->rows[i];
+    if (mask == 0)
+      break;
 
-    if(!tetris_check_bounds(fx, fy))
-      return 0;
+    field_row_t row_mask = tetris_shape_row_to_field(mask, x);
+    if ((row_mask & TETRIS_ROW_EMPTY) || fy >= TETRIS_HEIGHT)
+    {
+      in_bounds = 0;
+      row_mask &= ~TETRIS_ROW_EMPTY; // Only keep the valid part
+    }
 
-    if (fy < 0) // Ignore if higher than field
+    if (fy < 0 || fy >= TETRIS_HEIGHT) // Ignore if outside of the field
       continue;
 
-    findex_t iindex = tetris_field_item_get_index((uint8_t) fx, (uint8_t) fy);
-    tetris_field_item_set(field, iindex, value);
+    uint8_t type;
+    if (value == TETRIS_FIELD_EMPTY)
+    {
+      field->rows[fy] &= ~row_mask;
+      type = TETRIS_CELL_EMPTY;
+    }
+    else
+    {
+      field->rows[fy] |= row_mask;
+      type = value;
+    }
+
+    // Store the type of each cell
+    uint8_t fx = x - TETRIS_SHAPE_OFFSET;
+    for (; mask != 0; mask >>= 1, ++fx)
+    {
+      if ((mask & 0x01) && fx < TETRIS_WIDTH)
+        tetris_field_item_set_tetromino(field, fx, (uint8_t) fy, type);
+    }
   }
 
-  return 1;
+  return in_bounds;
+}
+
+static field_row_t
+tetris_shape_row_at (tetromino_t tetromino, uint8_t x, uint8_t y,
+                     uint8_t rotation, int8_t fy)
+{
+  const tetromino_shape_t *shape = &TETROMINO_SHAPE[tetromino][rotation];
+  int8_t i = fy - (int8_t) y - shape->top;
+  if (i < 0 || i > 3)
+    return 0;
+
+  return tetris_shape_row_to_field(shape->rows[i], x);
 }
 
 // --- Field ------------------------------------------------------------------
@@ -548,191 +688,369 @@ tetris_field_get_current (tetris_t *tetris)
 
 // --- Item -------------------------------------------------------------------
 
-static __inline findex_t
-tetris_field_item_get_index (uint8_t x, uint8_t y)
+static __inline void
+tetris_field_item_set_tetromino (field_t *field, uint8_t x, uint8_t y,
+                                 uint8_t type)
 {
-  //return (((findex_t) y) << 3) + (((findex_t) y) << 1) + ((findex_t) x);
-  return ((findex_t) y) * ((findex_t) TETRIS_WIDTH) + ((findex_t) x);
+  uint8_t shift = TETRIS_CELL_BITS * x;
+  field->types[y] = (field->types[y]
+      & ~(((field_types_t) TETRIS_CELL_EMPTY) << shift))
+      | (((field_types_t) type) << shift);
 }
 
-static __inline field_item_t*
-tetris_field_item_get_at (field_t *field, uint8_t x, uint8_t y)
+static void
+tetris_field_damage (uint8_t y, field_row_t columns)
 {
-  findex_t index = tetris_field_item_get_index(x, y);
-  return tetris_field_item_get(field, index);
+#ifdef TETRIS_DELTA_RENDERING
+  columns &= ~TETRIS_ROW_EMPTY;
+  if (y < TETRIS_TOP_HIDDEN || y >= TETRIS_HEIGHT || columns == 0)
+    return;
+
+  uint8_t *damage = &tetris_inst->damage[y - TETRIS_TOP_HIDDEN];
+  uint8_t first = *damage & 0x0F;
+  uint8_t last = *damage >> 4;
+
+  columns >>= TETRIS_FIELD_WALL_LEFT;
+  for (uint8_t col = 0; columns != 0; ++col, columns >>= 1)
+  {
+    if (!(columns & 0x01))
+      continue;
+
+    if (col < first)
+      first = col;
+    if (col > last)
+      last = col;
+  }
+
+  *damage = (last << 4) | first;
+#else
+  (void) y;
+  (void) columns;
+#endif
 }
 
-static __inline field_item_t*
-tetris_field_item_get (field_t *field, findex_t index)
+static field_row_t
+tetris_field_changed_columns (field_types_t changed)
 {
-  return &field->data[index];
+  field_row_t columns = 0;
+  field_row_t bit = 1 << TETRIS_FIELD_WALL_LEFT;
+  for (; changed != 0; bit <<= 1, changed >>= TETRIS_CELL_BITS)
+  {
+    if (changed & TETRIS_CELL_EMPTY)
+      columns |= bit;
+  }
+
+  return columns;
 }
 
-static __inline tetromino_t
-tetris_field_item_get_tetromino (field_item_t *item)
+// --- UART IO ----------------------------------------------------------------
+
+static bool_t
+tetris_game_send (tetris_t *tetris)
 {
-  return (tetromino_t) (*item & ~TETRIS_FIELD_EMPTY);
+  if (tetris->redraw != TETRIS_REDRAW_NONE && !tetris_game_send_screen(tetris))
+    return 0x00;
+
+#ifdef TETRIS_DELTA_RENDERING
+  if (!tetris_game_send_field_delta(tetris))
+    return 0x00;
+#else
+  tetris_game_send_field(tetris);
+#endif
+
+  return tetris_game_send_score_update(tetris)
+      && tetris_game_send_next_tetromino_update(tetris);
 }
 
-static __inline void
-tetris_field_item_set (field_t *field, findex_t index,
-                       field_item_t value)
+static bool_t
+tetris_game_send_screen (tetris_t *tetris)
+{
+  if (tetris->redraw == TETRIS_REDRAW_START)
+  {
+    tetris->redraw = TETRIS_REDRAW_HALF + UART_HALF_NONE;
+    tetris->dirty = 0;
+
+#ifdef TETRIS_DELTA_RENDERING
+    // Rows which change while the redraw is running are damaged again
+    for (uint8_t i = 0; i < TETRIS_HEIGHT - TETRIS_TOP_HIDDEN; ++i)
+      tetris->damage[i] = TETRIS_DAMAGE_NONE;
+#endif
+
+    uart_set_double_height(UART_HALF_NONE);
+#ifdef TETRIS_DEC_SCALE
+    screen_start(&tetris_dec_screen);
+#else
+    screen_start(&tetris_screen);
+#endif
+  }
+
+  while (screen_resume(TETRIS_SCREEN_SIZE))
+  {
+    if (tetris->redraw == TETRIS_REDRAW_HALF + TETRIS_HALF_LAST)
+    {
+      tetris->redraw = TETRIS_REDRAW_NONE;
+
+#ifdef TETRIS_DELTA_RENDERING
+      // The undamaged cells of the field show its current content
+      uart_set_screen_callback(&tetris_on_screen_read);
+#endif
+      return 0x01;
+    }
+
+    ++tetris->redraw;
+    uart_set_double_height(tetris->redraw - TETRIS_REDRAW_HALF);
+    screen_start(&tetris_screen);
+  }
+
+  return 0x00;
+}
+
+static void
+tetris_on_slot (uint8_t slot, uint8_t index)
+{
+  switch (slot)
+  {
+  case TETRIS_SLOT_ROW:
+    {
+      uint8_t row = TETRIS_TOP_HIDDEN + index / TETRIS_SCALE;
+      field_types_t types = tetris_field_get_current(tetris_inst)->types[row];
+
+      // The right border follows directly so blanks must be printed
+      tetris_game_send_line(TETRIS_Y + 1 + index, types, TETRIS_TYPES_EMPTY,
+                            0x00);
+      break;
+    }
+  case TETRIS_SLOT_SCORE:
+    if (tetris_inst->redraw == TETRIS_REDRAW_HALF + TETRIS_HALF_FIRST)
+      tetris_inst->shown_score = tetris_inst->score;
+
+    uart_send_number(tetris_inst->shown_score, TETRIS_SCORE_WIDTH,
+                     UART_PAD_ZERO);
+    break;
+  case TETRIS_SLOT_LEVEL:
+    uart_send_number_u16(tetris_inst->level, 1);
+    break;
+  case TETRIS_SLOT_NEXT:
+    if (tetris_inst->redraw == TETRIS_REDRAW_HALF + TETRIS_HALF_FIRST)
+      tetris_inst->preview = tetris_inst->tetro_next;
+
+    tetris_game_send_preview(tetris_inst->preview,
+                             TETROMINO_CHAR[tetris_inst->preview]);
+    break;
+  }
+}
+
+#ifdef TETRIS_DELTA_RENDERING
+static char
+tetris_on_screen_read (uint8_t v, uint8_t h)
 {
-  field_item_t *item = tetris_field_item_get(field, index);
-  *item = value;
+#ifdef TETRIS_DEC_SCALE
+  // Both halves of a double-height line show the same content
+  v = (v + 1) >> 1;
+#endif
+
+  v -= TETRIS_Y + 1;
+  h -= TETRIS_X + 1;
+
+  // Positions left / above of the field wrap around
+  if (v >= (TETRIS_HEIGHT - TETRIS_TOP_HIDDEN) * TETRIS_SCALE
+      || h >= TETRIS_WIDTH * TETRIS_SCALE)
+    return '\0';
+
+  // Damaged cells are not shown yet
+  uint8_t row = v / TETRIS_SCALE;
+  uint8_t col = h / TETRIS_SCALE;
+  uint8_t damage = tetris_inst->damage[row];
+  if (col >= (damage & 0x0F) && col <= (damage >> 4))
+    return '\0';
+
+  field_types_t types = tetris_field_get_current(tetris_inst)
+      ->types[TETRIS_TOP_HIDDEN + row] >> (col * TETRIS_CELL_BITS);
+  return TETROMINO_CHAR[types & TETRIS_CELL_EMPTY];
 }
 
 static __inline bool_t
-tetris_field_item_is_empty (field_item_t *item)
+tetris_game_send_field_delta (tetris_t *tetris)
 {
-  return (*item == TETRIS_FIELD_EMPTY);
-}
+  field_t *field = tetris_field_get_current(tetris);
+  uint8_t *damage = tetris->damage;
 
-// --- UART IO ----------------------------------------------------------------
+  for (uint8_t row = TETRIS_TOP_HIDDEN; row < TETRIS_HEIGHT; ++row, ++damage)
+  {
+    if (*damage == TETRIS_DAMAGE_NONE)
+      continue;
+
+    if (!uart_reserve(TETRIS_ROW_SIZE))
+      return 0x00;
+
+    // Columns from the first to the last damaged one
+    field_types_t changed = (TETRIS_TYPES_EMPTY
+        >> (TETRIS_CELL_BITS * (TETRIS_WIDTH - 1 - (*damage >> 4))))
+        & (TETRIS_TYPES_EMPTY << (TETRIS_CELL_BITS * (*damage & 0x0F)));
 
+    tetris_game_send_row(row, field->types[row], changed);
+    *damage = TETRIS_DAMAGE_NONE;
+  }
+
+  return 0x01;
+}
+#else
 static __inline void
 tetris_game_send_field (tetris_t *tetris)
 {
-  uint8_t y_offset = TETRIS_Y;
   field_t *field = tetris_field_get_current(tetris);
 
-  // Draw top border
-  uart_send_move_to(y_offset++, TETRIS_X);
-  uart_send(TETRIS_BORDER_C);
-  for (uint8_t i = TETRIS_SCALE * TETRIS_WIDTH; i-- > 0;)
-    uart_send((i & 0x01) ? TETRIS_BORDER_H : ' ');
-  uart_send(TETRIS_BORDER_C);
-
-  // Draw main game field
   for (uint8_t row = TETRIS_TOP_HIDDEN; row < TETRIS_HEIGHT; ++row)
+    tetris_game_send_row(row, field->types[row], TETRIS_TYPES_EMPTY);
+}
+#endif
+
+static void
+tetris_game_send_row (uint8_t row, field_types_t types,
+                      field_types_t changed)
+{
+  uint8_t v = TETRIS_Y + 1 + (row - TETRIS_TOP_HIDDEN) * TETRIS_SCALE;
+  for (uint8_t half = TETRIS_HALF_FIRST; half <= TETRIS_HALF_LAST; ++half)
+  {
+    uart_set_double_height(half);
+
+    for (uint8_t i = 0; i < TETRIS_SCALE; ++i)
+      tetris_game_send_line(v + i, types, changed, 0x01);
+  }
+}
+
+static void
+tetris_game_send_line (uint8_t v, field_types_t types, field_types_t changed,
+                       bool_t erase)
+{
+  char run_c = ' ';
+  uint8_t run_length = 0;
+
+  for (uint8_t col = 0; changed != 0; ++col)
   {
-    for (uint8_t i = TETRIS_SCALE; i-- > 0;)
+    if (changed & TETRIS_CELL_EMPTY)
     {
-      uart_send_move_to(y_offset++, TETRIS_X);
-      uart_send(TETRIS_BORDER_V);
+      char c = TETROMINO_CHAR[types & TETRIS_CELL_EMPTY];
 
-      for (uint8_t col = 0; col < TETRIS_WIDTH; ++col)
+      if (run_length == 0)
       {
-        char c;
-        field_item_t *item = tetris_field_item_get_at(field, col, row);
-        if (tetris_field_item_is_empty(item))
-          c = ' ';
-        else
-        {
-          c = TETROMINO_CHAR[tetris_field_item_get_tetromino(item)];
-        }
-
-        for (uint8_t j = TETRIS_SCALE; j-- > 0;)
-          uart_send(c);
+        uart_send_move_to(v, TETRIS_X + 1 + col * TETRIS_SCALE);
+        run_c = c;
+      }
+      else if (c != run_c)
+      {
+        uart_send_repeat(run_c, run_length);
+        run_c = c;
+        run_length = 0;
       }
 
-      uart_send(TETRIS_BORDER_V);
+      run_length += TETRIS_SCALE;
     }
+    else if (run_length != 0)
+    {
+      uart_send_repeat(run_c, run_length);
+      run_length = 0;
+    }
+
+    types >>= TETRIS_CELL_BITS;
+    changed >>= TETRIS_CELL_BITS;
   }
 
-  // Draw bottom border
-  uart_send_move_to(y_offset, TETRIS_X);
-  tetris_game_send_boxline(TETRIS_SCALE * TETRIS_WIDTH,
-                           TETRIS_BORDER_C, TETRIS_BORDER_H);
+  // Nothing is printed after the last run so blanks can be erased
+  if (erase && run_c == ' ')
+    uart_send_erase(run_length);
+  else
+    uart_send_repeat(run_c, run_length);
 }
 
-static __inline void
-tetris_game_send_score (tetris_t *tetris)
+static __inline bool_t
+tetris_game_send_score_update (tetris_t *tetris)
 {
-  uint8_t y_offset = TETRIS_SCORE_Y;
-
-  // Draw top score border
-  uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-  tetris_game_send_boxline(13, TETRIS_BORDER_C, TETRIS_BORDER_H);
-
-  uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-  uart_send(TETRIS_BORDER_V);
-  uart_send_string(" Score:      ");
-  uart_send(TETRIS_BORDER_V);
-
-  uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-  uart_send(TETRIS_BORDER_V);
-  uart_send_string("  ");
-  uart_send_number_u32(tetris->score, 1);
-  uart_send(' ');
-  uart_send(TETRIS_BORDER_V);
+  if (tetris->dirty & TETRIS_DIRTY_SCORE)
+  {
+    if (!uart_reserve(TETRIS_SCORE_SIZE))
+      return 0x00;
 
-  uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-  tetris_game_send_boxline(13, TETRIS_BORDER_V, ' ');
+    // Only the lower digits change with most updates
+    tetris->dirty &= ~TETRIS_DIRTY_SCORE;
+    for (uint8_t half = TETRIS_HALF_FIRST; half <= TETRIS_HALF_LAST; ++half)
+    {
+      uart_set_double_height(half);
+      uart_send_move_to(TETRIS_SCORE_Y + 2, TETRIS_SCORE_X + 3);
+      uart_send_number_update(tetris->score, tetris->shown_score,
+                              TETRIS_SCORE_WIDTH, UART_PAD_ZERO);
+    }
+    tetris->shown_score = tetris->score;
+  }
 
-  uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-  uart_send(TETRIS_BORDER_V);
-  uart_send_string(" Level:      ");
-  uart_send(TETRIS_BORDER_V);
+  if (tetris->dirty & TETRIS_DIRTY_LEVEL)
+  {
+    if (!uart_reserve(TETRIS_SCORE_SIZE))
+      return 0x00;
 
-  uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-  uart_send(TETRIS_BORDER_V);
-  uart_send_string("       ");
-  uart_send_number_u16(tetris->level, 1);
-  uart_send(' ');
-  uart_send(TETRIS_BORDER_V);
+    tetris->dirty &= ~TETRIS_DIRTY_LEVEL;
+    for (uint8_t half = TETRIS_HALF_FIRST; half <= TETRIS_HALF_LAST; ++half)
+    {
+      uart_set_double_height(half);
+      screen_printf(TETRIS_LEVEL_FORMAT, tetris->level);
+    }
+  }
 
-  // Draw bottom score border
-  uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-  tetris_game_send_boxline(13, TETRIS_BORDER_C, TETRIS_BORDER_H);
+  return 0x01;
 }
 
-static __inline void
-tetris_game_send_next_tetromino (tetris_t *tetris)
+static __inline bool_t
+tetris_game_send_next_tetromino_update (tetris_t *tetris)
 {
-  uint8_t y_offset = TETRIS_NEXT_Y;
-  uint8_t tetromino = tetris->tetro_next;
+  if (tetris->preview == tetris->tetro_next)
+    return 0x01;
 
-  // Draw top border
-  uart_send_move_to(y_offset++, TETRIS_NEXT_X);
-  tetris_game_send_boxline(13, TETRIS_BORDER_C, TETRIS_BORDER_H);
+  // Clear the old tetromino and draw the new one in separate parts
+  if (tetris->preview != TETROMINO_NONE)
+  {
+    if (!uart_reserve(TETRIS_PREVIEW_SIZE))
+      return 0x00;
 
-  uart_send_move_to(y_offset++, TETRIS_NEXT_X);
-  uart_send(TETRIS_BORDER_V);
-  uart_send_string(" Next:       ");
-  uart_send(TETRIS_BORDER_V);
+    for (uint8_t half = TETRIS_HALF_FIRST; half <= TETRIS_HALF_LAST; ++half)
+    {
+      uart_set_double_height(half);
+      tetris_game_send_preview(tetris->preview, ' ');
+    }
 
-  // Draw the 4 empty box lines
-  for (uint8_t j = 4; j-- > 0;)
-  {
-    uart_send_move_to(y_offset++, TETRIS_SCORE_X);
-    tetris_game_send_boxline(13, TETRIS_BORDER_V, ' ');
+    tetris->preview = TETROMINO_NONE;
   }
 
-  // Draw the next tetromino
-  const int8_t x_tetro_offset = (int8_t) TETROMINO_INIT_POS[tetromino][0];
-  const int8_t y_tetro_offset = (int8_t) TETROMINO_INIT_POS[tetromino][1];
-  const int8_t *tetroimino_fields = TETROMINO[tetromino];
-  const char c = TETROMINO_CHAR[tetromino];
-  for (uint8_t i = 4; i-- > 0;)
-  {
-    int8_t fx = (int8_t) TETRIS_SCORE_X + *(tetroimino_fields++) + 3;
-    int8_t fy = (int8_t) y_offset + *(tetroimino_fields++) - 3;
-    fx += x_tetro_offset;
-    fy += y_tetro_offset;
+  if (!uart_reserve(TETRIS_PREVIEW_SIZE))
+    return 0x00;
 
-    uart_send_move_to((uint8_t) fy, (uint8_t) fx);
-    uart_send(c);
+  for (uint8_t half = TETRIS_HALF_FIRST; half <= TETRIS_HALF_LAST; ++half)
+  {
+    uart_set_double_height(half);
+    tetris_game_send_preview(tetris->tetro_next,
+                             TETROMINO_CHAR[tetris->tetro_next]);
   }
 
-  // Draw bottom score border
-  uart_send_move_to(y_offset++, TETRIS_NEXT_X);
-  tetris_game_send_boxline(13, TETRIS_BORDER_C, TETRIS_BORDER_H);
+  tetris->preview = tetris->tetro_next;
+  return 0x01;
 }
 
-static __inline void
-tetris_game_send_boxline (uint8_t count, uint8_t edge, uint8_t fill)
+static void
+tetris_game_send_preview (tetromino_t tetromino, char c)
 {
-  uart_send(edge);
-  for (; count-- > 0;)
-    uart_send(fill);
-  uart_send(edge);
-}
+  const tetromino_shape_t *shape = &TETROMINO_SHAPE[tetromino][0];
+  uint8_t fy = TETRIS_NEXT_Y + 3 + TETROMINO_INIT_POS[tetromino][1]
+      + shape->top;
+  for (uint8_t i = 0; i < 4; ++i, ++fy)
+  {
+    uint8_t fx = TETRIS_NEXT_X + 3 + TETROMINO_INIT_POS[tetromino][0]
+        - TETRIS_SHAPE_OFFSET;
+    for (uint8_t mask = shape->rows[i]; mask != 0; mask >>= 1, ++fx)
+    {
+      if (!(mask & 0x01))
+        continue;
 
-static __inline void
-tetris_game_send (tetris_t *tetris)
-{
-  tetris_game_send_field(tetris);
-  tetris_game_send_score(tetris);
-  tetris_game_send_next_tetromino(tetris);
+      uart_send_move_to(fy, fx);
+      uart_send(c);
+    }
+  }
 }
@@ -9,92 +9,130 @@
 #include "inc/def.h"
 #include "inc/config.h"
 
-#include "inc/buffer.h"
+#include "inc/ring.h"
+#include "inc/screen.h"
 #include "inc/tetris.h"
 
 // ----------------------------------------------------------------------------
 // Definitions
 // ----------------------------------------------------------------------------
 
+#if !RING_IS_VALID_SIZE(TETRIS_CMD_BUFFER_SIZE)
+#error "TETRIS_CMD_BUFFER_SIZE has to be a power of two up to 128"
+#endif
+
 #define TETRIS_FIELD_EMPTY 0x80
 
+// Fall period of the first level in milliseconds (0.5 second)
+#define TETRIS_FALL_PERIOD 500
+
+// Number of wall bits on each side of a bitboard row
+#define TETRIS_FIELD_WALL_LEFT 3
+#define TETRIS_FIELD_WALL_RIGHT (16 - TETRIS_FIELD_WALL_LEFT - TETRIS_WIDTH)
+
+// Bitboard row values of an empty and a completely filled row
+#define TETRIS_ROW_EMPTY ((field_row_t) ~(((1 << TETRIS_WIDTH) - 1) \
+                                         << TETRIS_FIELD_WALL_LEFT))
+#define TETRIS_ROW_FULL ((field_row_t) 0xFFFF)
+
+// Type of an empty cell and of a completely empty type row
+#define TETRIS_CELL_EMPTY 0x07
+#define TETRIS_CELL_BITS 3
+#define TETRIS_TYPES_EMPTY ((((field_types_t) 1) \
+                             << (TETRIS_CELL_BITS * TETRIS_WIDTH)) - 1)
+
+// Damage of an unchanged row (First column after the last one)
+#define TETRIS_DAMAGE_NONE 0x0F
+
+// Side panel values which changed since the last update
+#define TETRIS_DIRTY_SCORE 0x01
+#define TETRIS_DIRTY_LEVEL 0x02
+
+// Tetromino masks are stored with column offset -2 in bit 0
+#define TETRIS_SHAPE_OFFSET 2
+
+#if TETRIS_WIDTH > 10
+#error "The bitboard only supports up to 10 columns"
+#endif
+
 // ----------------------------------------------------------------------------
 // Types
 // ----------------------------------------------------------------------------
 
-typedef uint16_t findex_t;
+/**
+ * Pre-computed shape of a tetromino in one rotation.
+ * The shape is stored as up to 4 row masks starting at the row offset top.
+ * Bit n of a row mask is set if the column offset (n - TETRIS_SHAPE_OFFSET)
+ * is occupied.
+ */
+typedef struct {
+  int8_t top;
+  uint8_t rows[4];
+} tetromino_shape_t;
 
 // ----------------------------------------------------------------------------
 // Constants
 // ----------------------------------------------------------------------------
 
 /*
- * Coordinates for each of the 4 states a tetromino can have.
- * Each coordinate is given in {x, y} format.
+ * Row masks for each of the 4 states a tetromino can have.
  * All tetromino blocks rotate clockwise.
  * The first entry is the initial state.
  */
-static const int8_t I_TETROMINO[4][4][2] = { // 'I' tetromino
-  {{-1, 0}, {0, 0}, {1, 0}, {2, 0}}, // Horiz
-  {{0, -2}, {0, -1}, {0, 0}, {0, 1}}, // Vert
-  {{-1, 0}, {0, 0}, {1, 0}, {2, 0}}, // Horiz
-  {{0, -2}, {0, -1}, {0, 0}, {0, 1}} // Vert
-};
-static const int8_t T_TETROMINO[4][4][2] = { // 'T' tetromino
-  {{-1, 0}, {0, 0}, {1, 0}, {0, 1}}, // Down
-  {{0, -1}, {0, 0}, {0, 1}, {-1, 0}}, // Left
-  {{-1, 0}, {0, 0}, {1, 0}, {0, -1}}, // Up
-  {{0, -1}, {0, 0}, {0, 1}, {1, 0}} // Right
-};
-static const int8_t Z_TETROMINO[4][4][2] = { // 'Z' tetromino
-  {{-1, -1}, {0, -1}, {0, 0}, {1, 0}}, // Horiz
-  {{1, -1}, {1, 0}, {0, 0}, {0, 1}}, // Vert
-  {{-1, -1}, {0, -1}, {0, 0}, {1, 0}}, // Horiz
-  {{1, -1}, {1, 0}, {0, 0}, {0, 1}} // Vert
-};
-static const int8_t Z_INV_TETROMINO[4][4][2] = { // inverse 'Z' tetromino
-  {{1, -1}, {0, -1}, {0, 0}, {-1, 0}}, // Horiz
-  {{-1, -1}, {-1, 0}, {0, 0}, {0, 1}}, // Vert
-  {{1, -1}, {0, -1}, {0, 0}, {-1, 0}}, // Horiz
-  {{-1, -1}, {-1, 0}, {0, 0}, {0, 1}} // Vert
-};
-static const int8_t L_TETROMINO[4][4][2] = { // 'L' tetromino
-  {{0, 1}, {0, 0}, {1, 0}, {2, 0}}, // Down
-  {{-1, 0}, {0, 0}, {0, 1}, {0, 2}}, // Left
-  {{-2, 0}, {-1, 0}, {0, 0}, {0, -1}}, // Up
-  {{0, -2}, {0, -1}, {0, 0}, {1, 0}} // Right
-};
-static const int8_t L_INV_TETROMINO[4][4][2] = { // inverse 'L' tetromino
-  {{-2, 0}, {-1, 0}, {0, 0}, {0, 1}}, // Down
-  {{-1, 0}, {0, 0}, {0, -1}, {0, -2}}, // Left
-  {{2, 0}, {1, 0}, {0, 0}, {0, -1}}, // Up
-  {{0, 2}, {0, 1}, {0, 0}, {1, 0}} // Right
-};
-static const int8_t O_TETROMINO[4][4][2] = { // '[]' tetromino
-  {{0, 0}, {1, 0}, {1, 1}, {0, 1}},
-  {{0, 0}, {1, 0}, {1, 1}, {0, 1}},
-  {{0, 0}, {1, 0}, {1, 1}, {0, 1}},
-  {{0, 0}, {1, 0}, {1, 1}, {0, 1}}
-};
-
-static const int8_t* const TETROMINO[7] = {
-  (const int8_t*) &I_TETROMINO,
-  (const int8_t*) &T_TETROMINO,
-  (const int8_t*) &Z_TETROMINO,
-  (const int8_t*) &Z_INV_TETROMINO,
-  (const int8_t*) &L_TETROMINO,
-  (const int8_t*) &L_INV_TETROMINO,
-  (const int8_t*) &O_TETROMINO
+static const tetromino_shape_t TETROMINO_SHAPE[7][4] = {
+  { // 'I' tetromino
+    {0, {0x1E, 0x00, 0x00, 0x00}}, // Horiz
+    {-2, {0x04, 0x04, 0x04, 0x04}}, // Vert
+    {0, {0x1E, 0x00, 0x00, 0x00}}, // Horiz
+    {-2, {0x04, 0x04, 0x04, 0x04}} // Vert
+  },
+  { // 'T' tetromino
+    {0, {0x0E, 0x04, 0x00, 0x00}}, // Down
+    {-1, {0x04, 0x06, 0x04, 0x00}}, // Left
+    {-1, {0x04, 0x0E, 0x00, 0x00}}, // Up
+    {-1, {0x04, 0x0C, 0x04, 0x00}} // Right
+  },
+  { // 'Z' tetromino
+    {-1, {0x06, 0x0C, 0x00, 0x00}}, // Horiz
+    {-1, {0x08, 0x0C, 0x04, 0x00}}, // Vert
+    {-1, {0x06, 0x0C, 0x00, 0x00}}, // Horiz
+    {-1, {0x08, 0x0C, 0x04, 0x00}} // Vert
+  },
+  { // inverse 'Z' tetromino
+    {-1, {0x0C, 0x06, 0x00, 0x00}}, // Horiz
+    {-1, {0x02, 0x06, 0x04, 0x00}}, // Vert
+    {-1, {0x0C, 0x06, 0x00, 0x00}}, // Horiz
+    {-1, {0x02, 0x06, 0x04, 0x00}} // Vert
+  },
+  { // 'L' tetromino
+    {0, {0x1C, 0x04, 0x00, 0x00}}, // Down
+    {0, {0x06, 0x04, 0x04, 0x00}}, // Left
+    {-1, {0x04, 0x07, 0x00, 0x00}}, // Up
+    {-2, {0x04, 0x04, 0x0C, 0x00}} // Right
+  },
+  { // inverse 'L' tetromino
+    {0, {0x07, 0x04, 0x00, 0x00}}, // Down
+    {-2, {0x04, 0x04, 0x06, 0x00}}, // Left
+    {-1, {0x04, 0x1C, 0x00, 0x00}}, // Up
+    {0, {0x0C, 0x04, 0x04, 0x00}} // Right
+  },
+  { // '[]' tetromino
+    {0, {0x0C, 0x0C, 0x00, 0x00}},
+    {0, {0x0C, 0x0C, 0x00, 0x00}},
+    {0, {0x0C, 0x0C, 0x00, 0x00}},
+    {0, {0x0C, 0x0C, 0x00, 0x00}}
+  }
 };
 
-static const char TETROMINO_CHAR[7] = {
+static const char TETROMINO_CHAR[8] = {
   TETRIS_TETROMINO_I,
   TETRIS_TETROMINO_T,
   TETRIS_TETROMINO_Z,
   TETRIS_TETROMINO_Z_INV,
   TETRIS_TETROMINO_L,
   TETRIS_TETROMINO_L_INV,
-  TETRIS_TETROMINO_O
+  TETRIS_TETROMINO_O,
+  ' ' // TETRIS_CELL_EMPTY
 };
 
 static const uint8_t TETROMINO_INIT_POS[7][2] = {
@@ -107,6 +145,139 @@ static const uint8_t TETROMINO_INIT_POS[7][2] = {
   {3, 0} // 'O' tetromino
 };
 
+/*
+ * Template of the game screen with the game field, the score panel and the
+ * next tetromino panel.
+ */
+#define TETRIS_SLOT_ROW 0x00
+#define TETRIS_SLOT_SCORE 0x01
+#define TETRIS_SLOT_LEVEL 0x02
+#define TETRIS_SLOT_NEXT 0x03
+
+#define TETRIS_FIELD_LINES (TETRIS_SCALE * (TETRIS_HEIGHT - TETRIS_TOP_HIDDEN))
+
+/*
+ * With TETRIS_DEC_SCALE every line of the game screen is a double-height
+ * line. The content is sent once for each half.
+ */
+#ifdef TETRIS_DEC_SCALE
+#if TETRIS_SCALE != 1
+#error "TETRIS_DEC_SCALE can't be combined with TETRIS_SCALE"
+#endif
+
+#define TETRIS_HALF_FIRST UART_HALF_TOP
+#define TETRIS_HALF_LAST UART_HALF_BOTTOM
+
+#define TETRIS_DEC_LINES MAX(TETRIS_Y + 1 + TETRIS_FIELD_LINES, \
+                             MAX(TETRIS_SCORE_Y + 6, TETRIS_NEXT_Y + 6))
+#else
+#define TETRIS_HALF_FIRST UART_HALF_NONE
+#define TETRIS_HALF_LAST UART_HALF_NONE
+#endif
+
+#define TETRIS_HALVES (TETRIS_HALF_LAST - TETRIS_HALF_FIRST + 1)
+
+// Digits of the score field in the side panel
+#define TETRIS_SCORE_WIDTH 10
+
+/*
+ * Stages of a screen redraw. The template is sent once for each half in the
+ * stage TETRIS_REDRAW_HALF + half. The first stage (UART_HALF_NONE) sets up
+ * the line sizes with TETRIS_DEC_SCALE.
+ */
+#define TETRIS_REDRAW_NONE 0x00
+#define TETRIS_REDRAW_START 0x01
+#define TETRIS_REDRAW_HALF 0x02
+
+/*
+ * Upper bounds of the bytes sent by each part of an update. A part is only
+ * sent if it fits into the transmit buffer, otherwise the update is continued
+ * with the latest state when the buffer drained. A cursor motion takes up to
+ * 8 bytes.
+ */
+#define TETRIS_LINE_SIZE (8 + TETRIS_SCALE * TETRIS_WIDTH)
+#define TETRIS_ROW_SIZE (TETRIS_HALVES * TETRIS_SCALE * TETRIS_LINE_SIZE)
+#define TETRIS_SCORE_SIZE (TETRIS_HALVES * (8 + TETRIS_SCORE_WIDTH))
+#define TETRIS_PREVIEW_SIZE (TETRIS_HALVES * 4 * (8 + 1))
+#define TETRIS_SCREEN_SIZE MAX(TETRIS_LINE_SIZE, 4 * (8 + 1))
+
+// Free space in the transmit buffer needed to start the next frame
+#define TETRIS_FRAME_SIZE (UART_T_BUFFER_SIZE - TETRIS_FRAME_BACKLOG)
+
+static const char * const TETRIS_TEXT[3] = {
+  " Score:      ",
+  " Level:      ",
+  " Next:       "
+};
+
+static const uint8_t TETRIS_SCREEN[] = {
+  // Game field with a dashed top border
+  SCREEN_MOVE(TETRIS_Y, TETRIS_X),
+  TETRIS_BORDER_C,
+#if (TETRIS_SCALE * TETRIS_WIDTH) & 0x01
+  ' ',
+#endif
+  SCREEN_REPEAT((TETRIS_SCALE * TETRIS_WIDTH) >> 1),
+    TETRIS_BORDER_H, ' ',
+  SCREEN_LOOP,
+  TETRIS_BORDER_C,
+  SCREEN_LINES(TETRIS_FIELD_LINES, TETRIS_Y + 1, TETRIS_X),
+    TETRIS_BORDER_V, SCREEN_SLOT(TETRIS_SLOT_ROW), TETRIS_BORDER_V,
+  SCREEN_LOOP,
+  SCREEN_MOVE(TETRIS_Y + 1 + TETRIS_FIELD_LINES, TETRIS_X),
+  SCREEN_BOXLINE(TETRIS_SCALE * TETRIS_WIDTH, TETRIS_BORDER_C, TETRIS_BORDER_H),
+
+  // Score panel
+  SCREEN_MOVE(TETRIS_SCORE_Y, TETRIS_SCORE_X),
+  SCREEN_BOXLINE(13, TETRIS_BORDER_C, TETRIS_BORDER_H),
+  SCREEN_MOVE(TETRIS_SCORE_Y + 1, TETRIS_SCORE_X),
+  TETRIS_BORDER_V, SCREEN_TEXT(0), TETRIS_BORDER_V,
+  SCREEN_MOVE(TETRIS_SCORE_Y + 2, TETRIS_SCORE_X),
+  TETRIS_BORDER_V, ' ', ' ', SCREEN_SLOT(TETRIS_SLOT_SCORE), ' ',
+  TETRIS_BORDER_V,
+  SCREEN_MOVE(TETRIS_SCORE_Y + 3, TETRIS_SCORE_X),
+  SCREEN_BOXLINE(13, TETRIS_BORDER_V, ' '),
+  SCREEN_MOVE(TETRIS_SCORE_Y + 4, TETRIS_SCORE_X),
+  TETRIS_BORDER_V, SCREEN_TEXT(1), TETRIS_BORDER_V,
+  SCREEN_MOVE(TETRIS_SCORE_Y + 5, TETRIS_SCORE_X),
+  TETRIS_BORDER_V, SCREEN_FILL(7, ' '), SCREEN_SLOT(TETRIS_SLOT_LEVEL), ' ',
+  TETRIS_BORDER_V,
+  SCREEN_MOVE(TETRIS_SCORE_Y + 6, TETRIS_SCORE_X),
+  SCREEN_BOXLINE(13, TETRIS_BORDER_C, TETRIS_BORDER_H),
+
+  // Next tetromino panel
+  SCREEN_MOVE(TETRIS_NEXT_Y, TETRIS_NEXT_X),
+  SCREEN_BOXLINE(13, TETRIS_BORDER_C, TETRIS_BORDER_H),
+  SCREEN_MOVE(TETRIS_NEXT_Y + 1, TETRIS_NEXT_X),
+  TETRIS_BORDER_V, SCREEN_TEXT(2), TETRIS_BORDER_V,
+  SCREEN_LINES(4, TETRIS_NEXT_Y + 2, TETRIS_NEXT_X),
+    SCREEN_BOXLINE(13, TETRIS_BORDER_V, ' '),
+  SCREEN_LOOP,
+  SCREEN_MOVE(TETRIS_NEXT_Y + 6, TETRIS_NEXT_X),
+  SCREEN_BOXLINE(13, TETRIS_BORDER_C, TETRIS_BORDER_H),
+  SCREEN_SLOT(TETRIS_SLOT_NEXT),
+
+  SCREEN_END
+};
+
+#ifdef TETRIS_DEC_SCALE
+static const uint8_t TETRIS_DEC_SCREEN[] = {
+  SCREEN_MOVE(1, 1),
+  SCREEN_REPEAT(TETRIS_DEC_LINES),
+    SCREEN_LINE_SIZE(UART_LINE_DOUBLE_TOP), '\n',
+    SCREEN_LINE_SIZE(UART_LINE_DOUBLE_BOTTOM), '\n',
+  SCREEN_LOOP,
+  SCREEN_END
+};
+#endif
+
+// Level value in the score panel (screen_printf)
+static const uint8_t TETRIS_LEVEL_FORMAT[] = {
+  SCREEN_MOVE(TETRIS_SCORE_Y + 5, TETRIS_SCORE_X + 8),
+  SCREEN_NUMBER(5, UART_PAD_ZERO),
+  SCREEN_END
+};
+
 /*
  * Pre-computed score result table:
  * points = (cleared rows)^2 * (successive clears)
@@ -161,6 +332,21 @@ static __inline uint8_t
 tetris_game_down (tetris_t *tetris, field_t *field);
 
 
+/**
+ * Marks the cells which changed by moving the tetromino from the given
+ * location to the current one. A locked tetromino was replaced by the next
+ * one, so all cells of both locations changed.
+ *
+ * @param tetromino The previous tetromino
+ * @param x The previous x location
+ * @param y The previous y location
+ * @param rotation The previous rotation
+ * @param locked If a tetromino was locked in the meantime
+ */
+static void
+tetris_game_damage_move (tetromino_t tetromino, uint8_t x, uint8_t y,
+                         uint8_t rotation, bool_t locked);
+
 /**
  * Increases the drop speed of all tetrominos.
  */
@@ -176,13 +362,18 @@ static __inline tetromino_t
 tetris_pick_random_tetromino (void);
 
 /**
- * Clears all full lines in the field and drops all lines above.
+ * Clears the full lines between the rows top and bottom and drops all lines
+ * above in a single pass.
+ * Only the rows spanned by the last placed tetromino can become full, so at
+ * most 4 rows are checked.
  *
  * @param field The field to clear full lines
+ * @param top The first row to check
+ * @param bottom The last row to check
  * @return Number of cleared lines
  */
 static __inline uint8_t
-tetris_field_clear_full_lines (field_t *field);
+tetris_field_clear_full_lines (field_t *field, uint8_t top, uint8_t bottom);
 
 /**
  * Updates the current score.
@@ -218,7 +409,8 @@ tetris_game_check_collision (field_t *field, tetromino_t tetromino,
  * @param x The x position of the tetromino
  * @param y The y position of the tetromino
  * @param rotation The rotation of the tetromino (range 0 to 4)
- * @param value The value set at the valid fields
+ * @param value The tetromino type to set or TETRIS_FIELD_EMPTY to clear the
+ *        fields
  * @return false if the tetromino was out of bounds
  */
 static bool_t
@@ -255,27 +447,35 @@ tetris_game_move(tetris_t *tetris, field_t *field, uint8_t direction);
 static bool_t
 tetris_on_timer (void);
 
+/**
+ * Callback method for the end of the frame interval.
+ *
+ * @return true if a frame was held back
+ */
+static bool_t
+tetris_on_frame_timer (void);
+
 /**
  * Callback method for received UART key presses.
  * The resulting game command will will finally get queued if there is enough
  * space.
  *
  * @param buffer The buffer to read key data from
- * @return true to wake up the CPU
+ * @return true if the game has to be updated
  */
 static bool_t
-tetris_on_key (buffer_t *buffer);
+tetris_on_key (ring_t *buffer);
 
 /**
- * Callback when a button is pressed.
+ * Callback for the button events.
  * The resulting game command will will finally get queued if there is enough
- * space.
+ * space. The moves repeat while their buttons are held down.
  *
- * @param button The button which was pressed
- * @return true to wake up the CPU
+ * @param event The button event
+ * @return true if the game has to be updated
  */
 static bool_t
-tetris_on_button (button_t button);
+tetris_on_button (const button_event_t *event);
 
 /**
  * Callback method for user / timer created command.
@@ -305,126 +505,216 @@ tetris_field_get_current (tetris_t *tetris);
 // --- Item -------------------------------------------------------------------
 
 /**
- * Returns a pointer to the location on the tetris field.
+ * Stores the tetromino type or TETRIS_CELL_EMPTY at the location.
+ * The occupancy bitboard is not modified.
  *
- * @param field The current tetris field
- * @param index The index of the item
- * @return The item at the specified position
+ * @param field The field to update
+ * @param x The x coordinate
+ * @param y The y coordinate
+ * @param type The tetromino type to store
  */
-static __inline field_item_t*
-tetris_field_item_get (field_t *field, findex_t index);
+static __inline void
+tetris_field_item_set_tetromino (field_t *field, uint8_t x, uint8_t y,
+                                 uint8_t type);
 
 /**
- * Returns a pointer to the location on the tetris field.
+ * Marks the changed cells of a row to be sent with the next update.
  *
- * @param field The current tetris field
- * @param x The x coordinate
- * @param y The y coordinate
- * @return The item at the specified position
+ * @param y The row which changed (Rows outside of the visible field are
+ *          ignored)
+ * @param columns The changed columns as bitboard row mask
  */
-static __inline field_item_t*
-tetris_field_item_get_at (field_t *field, uint8_t x, uint8_t y);
+static void
+tetris_field_damage (uint8_t y, field_row_t columns);
 
 /**
- * Returns the index of the specified location.
+ * Returns the columns in which two type rows differ.
  *
- * @param x The x coordinate
- * @param y The y coordinate
- * @return The index to access the item
+ * @param changed The XOR of both type rows
+ * @return The changed columns as bitboard row mask
  */
-static __inline findex_t
-tetris_field_item_get_index (uint8_t x, uint8_t y);
+static field_row_t
+tetris_field_changed_columns (field_types_t changed);
+
+// --- UART IO ----------------------------------------------------------------
 
 /**
- * Updates the item on the field.
- * The updated flag is set if the new value and old value differ.
+ * Sends the current field to the user including score and next tetrominos.
+ * The whole screen is only sent if a redraw was requested, otherwise only
+ * the changed parts are updated.
+ * The update stops if the transmit buffer is full and is continued by the
+ * next call (see uart_reserve).
  *
- * @param field The field to update
- * @param index The index of the item
- * @param value The new value
+ * @param tetris The main tetris instance
+ * @return If the terminal shows the current state
  */
-static __inline void
-tetris_field_item_set (field_t *field, findex_t index,
-                       field_item_t value);
+static bool_t
+tetris_game_send (tetris_t *tetris);
 
 /**
- * Returns if the location on the tetris field is empty.
+ * Sends the next parts of a requested screen redraw.
  *
- * @param item A pointer to the location on the field
- * @return true if the spot is occupied
+ * @param tetris The main tetris instance
+ * @return If the redraw is finished
  */
-static __inline bool_t
-tetris_field_item_is_empty (field_item_t *item);
+static bool_t
+tetris_game_send_screen (tetris_t *tetris);
 
 /**
- * Returns
+ * Callback method for the dynamic content of the game screen template.
  *
- * @param item
- * @return
+ * @param slot The slot to send
+ * @param index The line of the repeated block
  */
-static __inline tetromino_t
-tetris_field_item_get_tetromino (field_item_t *item);
+static void
+tetris_on_slot (uint8_t slot, uint8_t index);
 
-// --- UART IO ----------------------------------------------------------------
+#ifdef TETRIS_DELTA_RENDERING
+/**
+ * Callback method of the UART interface which returns the character
+ * displayed at a terminal position inside of the game field.
+ *
+ * @param v The row of the terminal position
+ * @param h The column of the terminal position
+ * @return The displayed character or '\0' outside of the game field
+ */
+static char
+tetris_on_screen_read (uint8_t v, uint8_t h);
 
 /**
- * Sends the current field to the user including score and next tetrominos.
+ * Sends only the damaged columns of the game field rows.
  *
  * @param tetris The main tetris instance
+ * @return If all changed rows were sent
  */
-static void
-tetris_game_send (tetris_t *tetris);
-
+static __inline bool_t
+tetris_game_send_field_delta (tetris_t *tetris);
+#else
 /**
- * Sends only the current game field to the user.
+ * Sends all cells of the game field without the border.
  *
  * @param tetris The main tetris instance
  */
 static __inline void
 tetris_game_send_field (tetris_t *tetris);
+#endif
 
 /**
- * Sends only the current score to the user.
+ * Sends the content of one game field row.
+ * Only the columns which are set in the change mask are sent.
+ * Each group of adjacent changed columns is preceded by a cursor movement.
+ *
+ * @param row The visible row to send
+ * @param types The types of the row
+ * @param changed The columns to send (Non-zero cells of TETRIS_CELL_BITS)
+ */
+static void
+tetris_game_send_row (uint8_t row, field_types_t types,
+                      field_types_t changed);
+
+/**
+ * Sends the content of one terminal line of a game field row.
+ * Runs of equal characters are compressed.
+ *
+ * @param v The terminal line to send
+ * @param types The types of the row
+ * @param changed The columns to send (Non-zero cells of TETRIS_CELL_BITS)
+ * @param erase If trailing blanks may be erased without moving the cursor
+ */
+static void
+tetris_game_send_line (uint8_t v, field_types_t types, field_types_t changed,
+                       bool_t erase);
+
+/**
+ * Sends only the score and level values which changed since the last update.
  *
  * @param tetris The main tetris instance
+ * @return If all changed values were sent
  */
-static __inline void
-tetris_game_send_score (tetris_t *tetris);
+static __inline bool_t
+tetris_game_send_score_update (tetris_t *tetris);
 
 /**
- * Draws a line of a box.
+ * Replaces the shown next tetromino if it changed since the last update.
  *
- * @param count The inner size of the box
- * @param edge The char used for the edges
- * @param fill The char used for the content
+ * @param tetris The main tetris instance
+ * @return If the shown next tetromino is up to date
  */
-static __inline void
-tetris_game_send_boxline (uint8_t count, uint8_t edge, uint8_t fill);
+static __inline bool_t
+tetris_game_send_next_tetromino_update (tetris_t *tetris);
+
+/**
+ * Draws the glyphs of a tetromino in the next tetromino panel.
+ *
+ * @param tetromino The tetromino to draw
+ * @param c The char used for each glyph
+ */
+static void
+tetris_game_send_preview (tetromino_t tetromino, char c);
 
 // --- Helper -----------------------------------------------------------------
 
 /**
- * Checks if the coordinate is in the tetris field.
- * If the y coordinate exceeds the height of the tetris field
- * the coordinate might be considered valid.
+ * Returns the bitboard row a tetromino row collides with.
+ * Rows above the field only contain the walls, rows below the field are
+ * completely filled.
+ *
+ * @param field The current tetris field
+ * @param y The y location (may be outside the field)
+ * @return The bitboard row
+ */
+__attribute__((always_inline))
+__inline field_row_t
+tetris_field_row_get (field_t *field, int8_t y);
+
+/**
+ * Shifts a tetromino row mask to the bitboard location of column x.
  *
- * @param x The x location
- * @param y The y location
- * @return true if the coordinate is valid
+ * @param mask The row mask of the tetromino shape
+ * @param x The x location of the tetromino
+ * @return The bitboard row mask
  */
 __attribute__((always_inline))
-__inline bool_t
-tetris_check_bounds (int8_t x, int8_t y);
+__inline field_row_t
+tetris_shape_row_to_field (uint8_t mask, uint8_t x);
+
+/**
+ * Returns the bitboard row mask of a tetromino in one field row.
+ *
+ * @param tetromino The tetromino
+ * @param x The x location of the tetromino
+ * @param y The y location of the tetromino
+ * @param rotation The rotation of the tetromino
+ * @param fy The field row
+ * @return The bitboard row mask (Zero if the tetromino is not in the row)
+ */
+static field_row_t
+tetris_shape_row_at (tetromino_t tetromino, uint8_t x, uint8_t y,
+                     uint8_t rotation, int8_t fy);
 
 // ----------------------------------------------------------------------------
 // Implementations
 // ----------------------------------------------------------------------------
 
 __attribute__((always_inline))
-__inline bool_t
-tetris_check_bounds (int8_t x, int8_t y)
+__inline field_row_t
+tetris_field_row_get (field_t *field, int8_t y)
+{
+  if (y < 0)
+    return TETRIS_ROW_EMPTY;
+
+  if (y >= TETRIS_HEIGHT)
+    return TETRIS_ROW_FULL;
+
+  return field->rows[y];
+}
+
+__attribute__((always_inline))
+__inline field_row_t
+tetris_shape_row_to_field (uint8_t mask, uint8_t x)
 {
-  return ((x >= 0) && (x < TETRIS_WIDTH) && (y < TETRIS_HEIGHT));
+  return ((field_row_t) mask)
+      << (x + TETRIS_FIELD_WALL_LEFT - TETRIS_SHAPE_OFFSET);
 }
 
 #endif // !__TETRIS_P_H
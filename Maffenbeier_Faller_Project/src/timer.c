@@ -7,11 +7,13 @@
 #include "inc/def.h"
 #include "inc/config.h"
 
+#include "inc/clock.h"
 #include "inc/timer.h"
 
 #include "timer_p.h"
 
-static bool_t (*timer_callbacks[TIMER_COUNT])(void);
+static timer_state_t timers[TIMER_COUNT];
+static timer_wheel_t wheel;
 
 void
 timer_init (timer_t timer)
@@ -19,19 +21,33 @@ timer_init (timer_t timer)
   if (!timer_check(timer))
     return;
 
-  // Remove a possible existing callback
-  timer_callbacks[timer] = 0;
-
-  switch (timer) {
-  case TIMER_1:
-    TA0R = 0; // Reset counter
-    TA0CTL = TASSEL_2; // Select SMCLK as source (1 MHz)
-    break;
-  case TIMER_2:
-    TA1R = 0; // Reset counter
-    TA1CTL = TASSEL_2; // Select SMCLK as source (1 MHz)
-    break;
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  // Start the shared counter on first use
+  if (!(TA0CTL & MC_2))
+  {
+    for (uint8_t i = 0; i < TIMER_WHEEL_SIZE; ++i)
+      wheel.heads[i] = TIMER_NONE;
+    for (uint8_t i = 0; i < TIMER_COUNT; ++i)
+      timers[i].slot = TIMER_NONE;
+
+    TA0CCTL0 = 0;
+    TA0CTL = TASSEL_2 | ID_3 | MC_2 | TACLR; // SMCLK / 8, continuous mode
+
+    // SMCLK / 8 ticks per slot
+    wheel.slot_ticks = TIMER_SLOT_MS * (clock_get_frequency() >> 3);
+    // Leave a slot of headroom for rounding the elapsed ticks in timer_arm
+    wheel.max_step = (0xFFFF - wheel.slot_ticks) / wheel.slot_ticks;
   }
+
+  // Remove a possible existing callback
+  if (timers[timer].slot != TIMER_NONE)
+    timer_unlink(timer);
+  timers[timer].callback = 0;
+  timers[timer].slots = 1;
+
+  __set_interrupt_state(state);
 }
 
 void
@@ -40,32 +56,28 @@ timer_start (timer_t timer)
   if (!timer_check(timer))
     return;
 
-  switch (timer) {
-  case TIMER_1:
-    TA0CCTL0 = (TA0CCTL0 & ~CCIFG) | CCIE; // Enable interrupt and remove flag
-    TA0CTL |= MC_1; // Enable counter
-    break;
-  case TIMER_2:
-    TA1CCTL0 = (TA1CCTL0 & ~CCIFG) | CCIE; // Enable interrupt and remove flag
-    TA1CTL |= MC_1; // Enable counter
-    break;
-  }
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  timers[timer].periodic = 0x01;
+  timer_arm(timer);
+
+  __set_interrupt_state(state);
 }
 
 void
-timer_start_counter (timer_t timer)
+timer_start_once (timer_t timer)
 {
   if (!timer_check(timer))
     return;
 
-  switch (timer) {
-  case TIMER_1:
-    TA0CTL |= MC_1; // Enable counter
-    break;
-  case TIMER_2:
-    TA1CTL |= MC_1; // Enable counter
-    break;
-  }
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  timers[timer].periodic = 0x00;
+  timer_arm(timer);
+
+  __set_interrupt_state(state);
 }
 
 void
@@ -74,16 +86,14 @@ timer_stop (timer_t timer)
   if (!timer_check(timer))
     return;
 
-  switch (timer) {
-  case TIMER_1:
-    TA0CCTL0 &= ~(CCIE | CCIFG); // Disable interrupt
-    TA0CTL &= ~(MC0 | MC1); // Disable counter
-    break;
-  case TIMER_2:
-    TA1CCTL0 &= ~(CCIE | CCIFG); // Disable interrupt
-    TA1CTL &= ~(MC0 | MC1); // Disable counter
-    break;
-  }
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  // An empty slot which is still pending only costs one interrupt
+  if (timers[timer].slot != TIMER_NONE)
+    timer_unlink(timer);
+
+  __set_interrupt_state(state);
 }
 
 void
@@ -92,14 +102,13 @@ timer_reset (timer_t timer)
   if (!timer_check(timer))
     return;
 
-  switch (timer) {
-  case TIMER_1:
-    TA0R = 0;
-    break;
-  case TIMER_2:
-    TA1R = 0;
-    break;
-  }
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  if (timers[timer].slot != TIMER_NONE)
+    timer_arm(timer);
+
+  __set_interrupt_state(state);
 }
 
 bool_t
@@ -108,131 +117,222 @@ timer_is_running (timer_t timer)
   if (!timer_check(timer))
     return 0;
 
-  switch (timer) {
-  case TIMER_1:
-    return TA0CTL & (MC0 | MC1);
-  case TIMER_2:
-    return TA1CTL & (MC0 | MC1);
-  default:
-    return 0;
-  }
+  return (timers[timer].slot != TIMER_NONE);
 }
 
 void
-timer_set_interval (timer_t timer, uint16_t interval)
+timer_set_period (timer_t timer, uint16_t period)
 {
   if (!timer_check(timer))
     return;
 
-  switch (timer) {
-  case TIMER_1:
-    TA0CCR0 = interval;
-    break;
-  case TIMER_2:
-    TA1CCR0 = interval;
-    break;
-  }
+  uint16_t slots = (period + (TIMER_SLOT_MS >> 1)) / TIMER_SLOT_MS;
+  if (slots == 0)
+    slots = 1;
+  else if (slots > 0xFF)
+    slots = 0xFF;
+
+  timers[timer].slots = (uint8_t) slots;
 }
 
 uint16_t
-timer_get_interval (timer_t timer)
+timer_get_period (timer_t timer)
 {
   if (!timer_check(timer))
     return 0;
 
-  switch (timer) {
-  case TIMER_1:
-    return TA0CCR0;
-  case TIMER_2:
-    return TA1CCR0;
-  default:
-    return 0;
-  }
+  return timers[timer].slots * TIMER_SLOT_MS;
+}
+
+uint16_t
+timer_get_time (void)
+{
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  uint16_t slot = timer_get_slot();
+
+  __set_interrupt_state(state);
+  return slot * TIMER_SLOT_MS;
+}
+
+uint16_t
+timer_get_ticks (void)
+{
+  return TA0R;
 }
 
 void
-timer_set_divider (timer_t timer, timer_divider_t divider)
+timer_set_callback (timer_t timer, bool_t (*callback)(void))
 {
   if (!timer_check(timer))
     return;
 
-  if (!timer_check_divider(divider))
+  // Update the callback method
+  timers[timer].callback = callback;
+}
+
+static uint16_t
+timer_get_slot (void)
+{
+  // The wheel stands still while no timer is running
+  if (!(TA0CCTL0 & CCIE))
+    return wheel.now;
+
+  // The pending slot is reached but not processed yet
+  if (TA0CCTL0 & CCIFG)
+    return wheel.pending;
+
+  // Round to the nearest slot boundary, so deadlines computed from it lie at
+  // least half a slot in the future
+  return wheel.now + (uint16_t) (TA0R - wheel.base + (wheel.slot_ticks >> 1))
+      / wheel.slot_ticks;
+}
+
+static void
+timer_arm (timer_t timer)
+{
+  if (timers[timer].slot != TIMER_NONE)
+    timer_unlink(timer);
+
+  bool_t active = (TA0CCTL0 & CCIE) != 0;
+  if (!active)
+  {
+    // The wheel stood still
+    wheel.base = TA0R;
+    TA0CCTL0 &= ~CCIFG;
+  }
+
+  uint16_t current = timer_get_slot();
+  uint16_t deadline = current + timers[timer].slots;
+  timer_link(timer, deadline);
+
+  if (!active)
+  {
+    timer_schedule();
     return;
+  }
 
-  switch (timer) {
-  case TIMER_1:
-    TA0CTL = (TA0CTL & ~(ID0 | ID1)) | (divider << 6);
-    break;
-  case TIMER_2:
-    TA1CTL = (TA1CTL & ~(ID0 | ID1)) | (divider << 6);
-    break;
+  // Later deadlines are picked up by the interrupt of the pending slot.
+  // Slots between the last and the current one may lie in the past, so an
+  // earlier deadline is set directly (It lies before the pending slot which
+  // is at most max_step slots away).
+  if ((uint16_t) (deadline - wheel.now)
+      < (uint16_t) (wheel.pending - wheel.now))
+  {
+    timer_set_pending(deadline);
   }
 }
 
-timer_divider_t
-timer_get_divider (timer_t timer)
+static void
+timer_link (uint8_t timer, uint16_t deadline)
 {
-  if (!timer_check(timer))
-    return TIMER_DIVIDER_1;
-
-  switch (timer) {
-  case TIMER_1:
-    return (timer_divider_t) (TA0CTL & (ID0 | ID1)) >> 6;
-  case TIMER_2:
-    return (timer_divider_t) (TA1CTL & (ID0 | ID1)) >> 6;
-  default:
-    return TIMER_DIVIDER_1;
-  }
+  timer_state_t *t = &timers[timer];
+  uint8_t slot = (uint8_t) deadline & TIMER_WHEEL_MASK;
+
+  // Visits of the slot in other turns leave the timer in the list
+  t->turn = (uint8_t) (deadline >> TIMER_WHEEL_SHIFT);
+  t->slot = slot;
+
+  t->next = wheel.heads[slot];
+  wheel.heads[slot] = timer;
 }
 
-uint16_t
-timer_get_value (timer_t timer)
+static void
+timer_unlink (uint8_t timer)
 {
-  if (!timer_check(timer))
-    return 0;
+  timer_state_t *t = &timers[timer];
 
-  switch (timer) {
-  case TIMER_1:
-    return TA0R;
-  case TIMER_2:
-    return TA1R;
-  default:
-    return 0;
-  }
+  // The lists hold a few timers only
+  uint8_t *link = &wheel.heads[t->slot];
+  while (*link != timer)
+    link = &timers[*link].next;
+  *link = t->next;
+
+  t->slot = TIMER_NONE;
 }
 
-void
-timer_set_callback (timer_t timer, bool_t (*callback)(void))
+static void
+timer_schedule (void)
 {
-  if (!timer_check(timer))
+  uint8_t step;
+  for (step = 1; step <= TIMER_WHEEL_SIZE; ++step)
+  {
+    if (wheel.heads[(uint8_t) (wheel.now + step) & TIMER_WHEEL_MASK]
+        != TIMER_NONE)
+      break;
+  }
+
+  if (step > TIMER_WHEEL_SIZE)
+  {
+    // No timer is running
+    TA0CCTL0 &= ~(CCIE | CCIFG);
     return;
+  }
 
-  // Update the callback method
-  timer_callbacks[timer] = callback;
+  // Far slots are reached with several interrupts at high frequencies
+  if (step > wheel.max_step)
+    step = wheel.max_step;
+
+  timer_set_pending(wheel.now + step);
+}
+
+static void
+timer_set_pending (uint16_t slot)
+{
+  wheel.pending = slot;
+  TA0CCR0 = wheel.base + (uint16_t) (slot - wheel.now) * wheel.slot_ticks;
+  TA0CCTL0 |= CCIE;
 }
 
 #pragma vector=TIMER0_A0_VECTOR
 __interrupt void
-timer_int0 (void)
+timer_int (void)
 {
   bool_t (*callback)(void);
+  uint8_t expired = 0x00;
+  bool_t wake_cpu = 0x00;
 
   TA0CCTL0 &= ~CCIFG; // Reset interrupt flag
 
-  callback = timer_callbacks[0];
-  if (callback != 0 && callback())
-    __bic_SR_register_on_exit(CPUOFF);
-}
+  wheel.now = wheel.pending;
+  wheel.base = TA0CCR0;
+
+  // Take the due timers out of the slot and re-insert periodic ones
+  uint8_t turn = (uint8_t) (wheel.now >> TIMER_WHEEL_SHIFT);
+  uint8_t *link = &wheel.heads[(uint8_t) wheel.now & TIMER_WHEEL_MASK];
+  uint8_t timer;
+  while ((timer = *link) != TIMER_NONE)
+  {
+    timer_state_t *t = &timers[timer];
+    if (t->turn != turn)
+    {
+      link = &t->next;
+      continue;
+    }
+
+    *link = t->next;
+    t->slot = TIMER_NONE;
+    expired |= 1 << timer;
+
+    // A timer inserted in front of this list expires in a later turn
+    if (t->periodic)
+      timer_link(timer, wheel.now + t->slots);
+  }
 
-#pragma vector=TIMER1_A0_VECTOR
-__interrupt void
-timer_int1 (void)
-{
-  bool_t (*callback)(void);
+  timer_schedule();
 
-  TA1CCTL0 &= ~CCIFG; // Reset interrupt flag
+  // The wheel is consistent, so the callbacks may modify the timers
+  for (timer = 0; expired != 0; ++timer, expired >>= 1)
+  {
+    if (!(expired & 0x01))
+      continue;
+
+    callback = timers[timer].callback;
+    if (callback != 0 && callback())
+      wake_cpu = 0x01;
+  }
 
-  callback = timer_callbacks[1];
-  if (callback != 0 && callback())
+  if (wake_cpu)
     __bic_SR_register_on_exit(CPUOFF);
 }
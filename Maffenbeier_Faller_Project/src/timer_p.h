@@ -8,8 +8,65 @@
 // Definitions
 // ----------------------------------------------------------------------------
 
-#define TIMER_COUNT 2
-#define TIMER_DIVIDER_COUNT 4
+#define TIMER_COUNT 4 // Up to 8 (Bit mask of expired timers)
+
+#if TIMER_COUNT > 8
+#error "The timer interrupt supports up to 8 virtual timers"
+#endif
+
+// Resolution of the timers in milliseconds
+#define TIMER_SLOT_MS 10
+
+// Number of slots of the timer wheel (Power of two)
+#define TIMER_WHEEL_SIZE 8
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SIZE - 1)
+#define TIMER_WHEEL_SHIFT 3
+
+// End of a slot list and slot of a stopped timer
+#define TIMER_NONE 0xFF
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+typedef struct {
+  bool_t (*callback)(void);
+
+  // Period in slots
+  uint8_t slots;
+
+  // Turn of the wheel in which the timer expires in its slot (Lower bits of
+  // the deadline / TIMER_WHEEL_SIZE)
+  uint8_t turn;
+
+  // Slot of the running timer (TIMER_NONE if stopped) and the next timer in
+  // the list of the slot
+  uint8_t slot;
+  uint8_t next;
+
+  bool_t periodic;
+} timer_state_t;
+
+/**
+ * A hashed timer wheel: Each slot lists the timers which expire in a slot
+ * with the same index modulo TIMER_WHEEL_SIZE. Timers further away are kept
+ * until the turn of their deadline. CCR0 only triggers at the next occupied
+ * slot, no deadline lies before the pending slot.
+ */
+typedef struct {
+  uint8_t heads[TIMER_WHEEL_SIZE];
+
+  // Last processed slot and its counter value (Slots count freely)
+  uint16_t now;
+  uint16_t base;
+
+  // Slot which CCR0 is set to (Not after the earliest deadline)
+  uint16_t pending;
+
+  // Counter ticks per slot and the maximum number of slots per interrupt
+  uint16_t slot_ticks;
+  uint8_t max_step;
+} timer_wheel_t;
 
 // ----------------------------------------------------------------------------
 // Methods
@@ -25,13 +82,54 @@ __inline bool_t
 timer_check (timer_t timer);
 
 /**
- * Returns if this divider exists.
+ * Returns the slot of the current time rounded to the nearest slot boundary.
+ * Must be called with disabled interrupts.
  *
- * @param divider The divider to check
- * @return true if the value is a valid divider
+ * @return The current slot
  */
-__inline bool_t
-timer_check_divider (timer_divider_t divider);
+static uint16_t
+timer_get_slot (void);
+
+/**
+ * Starts the timer from the current slot.
+ * Must be called with disabled interrupts.
+ *
+ * @param timer The timer to start
+ */
+static void
+timer_arm (timer_t timer);
+
+/**
+ * Inserts the timer into the slot of the deadline.
+ *
+ * @param timer The timer to insert
+ * @param deadline The slot in which the timer expires
+ */
+static void
+timer_link (uint8_t timer, uint16_t deadline);
+
+/**
+ * Removes the running timer from its slot.
+ *
+ * @param timer The timer to remove
+ */
+static void
+timer_unlink (uint8_t timer);
+
+/**
+ * Sets CCR0 to the next occupied slot or disables the interrupt if no timer
+ * is running. A single interrupt covers up to max_step slots.
+ */
+static void
+timer_schedule (void);
+
+/**
+ * Sets CCR0 to the slot.
+ *
+ * @param slot The slot to interrupt at (Up to max_step after the last one)
+ */
+static void
+timer_set_pending (uint16_t slot);
 
 // ----------------------------------------------------------------------------
 // Implementations
@@ -43,10 +141,4 @@ timer_check (timer_t timer)
   return (timer < TIMER_COUNT);
 }
 
-__inline bool_t
-timer_check_divider (timer_divider_t divider)
-{
-  return (divider < TIMER_DIVIDER_COUNT);
-}
-
 #endif // !__TIMER_P_H
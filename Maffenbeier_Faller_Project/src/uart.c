@@ -1,14 +1,14 @@
 // (c) Tobias Faller 2017
 // (c) Tim Maffenbeier 2017
 
-#include <inc/buffer.h>
 #include <msp430.h>
 #include <stdint.h>
 
 #include "inc/def.h"
 #include "inc/config.h"
 
-#include "inc/buffer.h"
+#include "inc/clock.h"
+#include "inc/ring.h"
 #include "inc/uart.h"
 
 #include "uart_p.h"
@@ -24,207 +24,803 @@ static uart_t uart;
 // ----------------------------------------------------------------------------
 
 void
-uart_init (uint8_t *r_buffer, uint16_t r_size,
-           uint8_t *t_buffer, uint16_t t_size)
+uart_init (uint8_t *r_buffer, uint8_t r_size,
+           uint8_t *t_buffer, uint8_t t_size)
 {
-  uart.r_buffer.buffer = r_buffer;
-  uart.r_buffer.buffer_size = r_size;
-  uart.r_buffer.start = 0;
-  uart.r_buffer.fill = 0;
-
-  uart.t_buffer.buffer = t_buffer;
-  uart.t_buffer.buffer_size = t_size;
-  uart.t_buffer.start = 0;
-  uart.t_buffer.fill = 0;
+  ring_init(&uart.r_buffer, r_buffer, r_size);
+  ring_init(&uart.t_buffer, t_buffer, t_size);
+
+  keys_init();
+  uart.r_ready = 0;
+  uart.r_dropped = 0;
+  uart.r_stopped = 0;
+  uart.t_pause = UART_PAUSE_NONE;
+  uart.t_control = UART_CONTROL_NONE;
+  uart.t_idle = 0x01;
+  uart.t_span = 0;
+  uart.t_span_length = 0;
+  uart.s_head = 0;
+  uart.s_tail = 0;
 
   uart.t_wait = UART_SEND_NOT_WAITING;
+  uart.t_wakeup = UART_WAKEUP_NONE;
+  uart.t_ready = 0;
+  uart.cursor_v = UART_CURSOR_UNKNOWN;
+  uart.cursor_h = 0;
+  uart.half = UART_HALF_NONE;
+  uart.rate = UART_RATE_DEFAULT;
   uart.r_callback = 0;
+  uart.s_callback = 0;
 
   // Enable secondary function on UART pins
   P1SEL |= BIT1 + BIT2;
   P1SEL2 |= BIT1 + BIT2;
 
+  UCA0CTL1 = UCSWRST; // Hold the USCI in reset during the configuration
+#ifdef UART_AUTO_BAUD
+  // Asynchronous UART 8 bit, 1 stop bit and without parity which detects the
+  // baud rate (Required by UCABDEN)
+  UCA0CTL0 = UCMODE_3;
+#else
   UCA0CTL0 = 0; // Asynchronous UART 8 bit, 1 stop bit and without parity
-  UCA0CTL1 = UCSSEL_2 // SMCLK as source
+#endif
+  UCA0CTL1 = UCSWRST
+      | UCSSEL_2 // SMCLK as source
       | UCBRKIE; // Allow break character for interrupt
-  UCA0MCTL = 0;
   UCA0STAT = 0;
   UCA0IRTCTL = 0;
   UCA0IRRCTL = 0;
+#ifdef UART_AUTO_BAUD
+  UCA0ABCTL = UCABDEN; // Measure the synch field after a break
+#else
   UCA0ABCTL = 0;
-  UCA0BR0 = (uint8_t) (UART_PRESCALER & 0xFF);
-  UCA0BR1 = (uint8_t) ((UART_PRESCALER >> 8) & 0xFF);
-  UCA0MCTL = UART_MODULATION;
+#endif
+  uart_set_divisors();
+  UCA0CTL1 &= ~UCSWRST;
 
   // Enable receive / transmit interrupt
   IE2 |= UCA0TXIE | UCA0RXIE;
 }
 
+bool_t
+uart_set_fast (bool_t fast)
+{
+  uint8_t rate = fast ? UART_RATE_FAST : UART_RATE_DEFAULT;
+  if (!UART_DIVISORS[rate][clock_get_profile()].valid)
+    return 0x00;
+
+  // The divisors can't change while a character is sent
+  uart_flush();
+
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  uart.rate = rate;
+
+  // The reset also disables the interrupts
+  UCA0CTL1 |= UCSWRST;
+  uart_set_divisors();
+  UCA0CTL1 &= ~UCSWRST;
+
+  IE2 |= UCA0TXIE | UCA0RXIE;
+
+  __set_interrupt_state(state);
+  return 0x01;
+}
+
+bool_t
+uart_check_fast (void)
+{
+  return UART_DIVISORS[UART_RATE_FAST][clock_get_profile()].valid;
+}
+
 void
-uart_set_receive_callback (bool_t (*callback)(buffer_t *buffer))
+uart_flush (void)
 {
-  uart.r_callback = callback;
+  __disable_interrupt();
+  if (!uart.t_idle)
+    uart_wait_empty();
+  __enable_interrupt();
+
+  // Wait for the last character in the shift register
+  while (UCA0STAT & UCBUSY);
 }
 
 void
-uart_send (uint8_t c)
+uart_set_receive_callback (bool_t (*callback)(ring_t *buffer))
+{
+  uart.r_callback = callback;
+}
+
+bool_t
+uart_process (void)
 {
-  if (buffer_is_full(&uart.t_buffer)) {
-    // Enable reentrant interrupts and wait until buffer is empty
-    uart.t_wait = UART_SEND_WAITING;
+  if (!uart.r_ready)
+    return 0x00;
 
-    while (uart.t_wait == UART_SEND_WAITING)
-      __bis_SR_register(GIE + CPUOFF);
+  uart.r_ready = 0;
+
+  bool_t (*callback)(ring_t *buffer) = uart.r_callback;
+  if (callback == 0)
+  {
+    // Nobody is interested in the data
+    ring_clear(&uart.r_buffer);
+    return 0x00;
   }
 
-  buffer_enqueue(&uart.t_buffer, c);
+  bool_t result = callback(&uart.r_buffer);
 
-  if (!(UCA0STAT & UCBUSY)) {
-    // Send next character (The interrupt flag is automatically cleared)
-    UCA0TXBUF = buffer_dequeue(&uart.t_buffer);
+#ifdef UART_FLOW_CONTROL
+  if (uart.r_stopped && ring_get_fill(&uart.r_buffer) <= UART_R_LOW)
+  {
+    // Let the host continue
+    __disable_interrupt();
+    uart.r_stopped = 0;
+    uart_send_control(UART_XON);
+    __enable_interrupt();
   }
+#endif
+
+  return result;
+}
+
+uint16_t
+uart_get_dropped (void)
+{
+  return uart.r_dropped;
 }
 
 void
-uart_send_move_to (uint8_t v, uint8_t h)
+uart_set_screen_callback (char (*callback)(uint8_t v, uint8_t h))
 {
-  uart_send(UART_ESC);
-  uart_send('[');
-  uart_send_number_u8(v, 0);
-  uart_send(';');
-  uart_send_number_u8(h, 0);
-  uart_send('H');
+  uart.s_callback = callback;
 }
 
 void
-uart_send_string (char *buffer)
+uart_invalidate_screen (void)
 {
-  for (; *buffer != '\0'; ++buffer)
-    uart_send(*buffer);
+  uart.cursor_v = UART_CURSOR_UNKNOWN;
+  uart.s_callback = 0;
 }
 
 void
-uart_send_number_u8 (uint8_t value, bool_t leading_zero)
+uart_send (uint8_t c)
 {
-  uint8_t v;
+  // NUL is a fill character for the terminal and marks a span in the queue
+  if (c == UART_SPAN_MARKER)
+    return;
 
-  for (v = '0'; value >= 100; value -= 100, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  uart_track(c);
+  uart_enqueue(c);
+}
 
-  for (v = '0'; value >= 10; value -= 10, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+void
+uart_send_bytes (const uint8_t *data, uint8_t length)
+{
+  for (uint8_t i = 0; i < length; ++i)
+    uart_track(data[i]);
+
+  uart_enqueue_bytes(data, length);
+}
+
+bool_t
+uart_reserve (uint8_t size)
+{
+  uint8_t buffer_size = uart.t_buffer.mask + 1;
+  uint8_t fill = buffer_size - MIN(size, buffer_size);
+
+  if (ring_get_fill(&uart.t_buffer) <= fill)
+    return 0x01;
+
+  // Request the wake up before checking again so no interrupt gets lost
+  uart.t_wakeup = fill + 1;
+  if (ring_get_fill(&uart.t_buffer) > fill)
+    return 0x00;
+
+  uart.t_wakeup = UART_WAKEUP_NONE;
+  return 0x01;
+}
+
+bool_t
+uart_check_ready (void)
+{
+  if (uart.r_ready)
+    return 0x01;
+
+  if (!uart.t_ready)
+    return 0x00;
 
-  uart_send('0' + value);
+  uart.t_ready = 0;
+  return 0x01;
 }
 
 void
-uart_send_number_u16 (uint16_t value, bool_t leading_zero)
+uart_send_move_to (uint8_t v, uint8_t h)
 {
-  uint8_t v;
+  // The terminal treats the position 0 like 1
+  if (v == 0)
+    v = 1;
+  if (h == 0)
+    h = 1;
 
-  for (v = '0'; value >= 10000; value -= 10000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  if (uart.half != UART_HALF_NONE)
+    v = (v << 1) - 2 + uart.half;
 
-  for (v = '0'; value >= 1000; value -= 1000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  uint8_t cursor_v = uart.cursor_v;
+  uint8_t cursor_h = uart.cursor_h;
 
-  for (v = '0'; value >= 100; value -= 100, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  if (cursor_v == v && cursor_h == h)
+    return;
 
-  for (v = '0'; value >= 10; value -= 10, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  // Length of the absolute motion ESC [ v ; h H without default values
+  uint8_t length = 3;
+  if (v != 1)
+    length += (v >= 100) ? 3 : (v >= 10) ? 2 : 1;
+  if (h != 1)
+    length += (h >= 100) ? 4 : (h >= 10) ? 3 : 2;
+
+  if (cursor_v != UART_CURSOR_UNKNOWN) {
+    // Vertical motion with LF / CUD or CUU
+    uint8_t length_v = 0;
+    if (v > cursor_v) {
+      length_v = uart_csi_length(v - cursor_v);
+      if (v - cursor_v < length_v)
+        length_v = v - cursor_v;
+    } else if (v < cursor_v) {
+      length_v = uart_csi_length(cursor_v - v);
+    }
+
+    // Horizontal motion
+    uint8_t motion = UART_MOTION_NONE;
+    uint8_t motion_cr = UART_MOTION_NONE;
+    uint8_t length_h = 0;
+    if (h > cursor_h) {
+      length_h = uart_forward_length(v, cursor_h, h, &motion);
+    } else if (h < cursor_h) {
+      uint8_t length_cr = 1 + uart_forward_length(v, 1, h, &motion_cr);
+
+      motion = UART_MOTION_BACKSPACE;
+      length_h = cursor_h - h;
+
+      if (uart_csi_length(cursor_h - h) < length_h) {
+        motion = UART_MOTION_BACKWARD;
+        length_h = uart_csi_length(cursor_h - h);
+      }
+
+      if (length_cr < length_h) {
+        motion = UART_MOTION_RETURN;
+        length_h = length_cr;
+      }
+    }
+
+    if (length_v + length_h < length) {
+      if (v > cursor_v) {
+        if (v - cursor_v == length_v) {
+          uart_enqueue_repeat('\n', length_v);
+        } else {
+          uart_send_csi(v - cursor_v, 'B');
+        }
+      } else if (v < cursor_v) {
+        uart_send_csi(cursor_v - v, 'A');
+      }
+
+      switch (motion) {
+      case UART_MOTION_FORWARD:
+      case UART_MOTION_OVERWRITE:
+        uart_send_forward(v, cursor_h, h, motion);
+        break;
+      case UART_MOTION_BACKSPACE:
+        uart_enqueue_repeat('\b', cursor_h - h);
+        break;
+      case UART_MOTION_BACKWARD:
+        uart_send_csi(cursor_h - h, 'D');
+        break;
+      case UART_MOTION_RETURN:
+        uart_send('\r');
+        uart_send_forward(v, 1, h, motion_cr);
+        break;
+      }
+
+      uart.cursor_v = v;
+      uart.cursor_h = h;
+      return;
+    }
+  }
 
-  uart_send('0' + value);
+  uint8_t sequence[10];
+  sequence[0] = UART_ESC;
+  sequence[1] = '[';
+  length = 2;
+  if (v != 1)
+    length += uart_format_u8(sequence + length, v, 0);
+  if (h != 1) {
+    sequence[length++] = ';';
+    length += uart_format_u8(sequence + length, h, 0);
+  }
+  sequence[length++] = 'H';
+
+  uart_enqueue_bytes(sequence, length);
+
+  uart.cursor_v = v;
+  uart.cursor_h = h;
 }
 
 void
-uart_send_number_u32 (uint32_t value, bool_t leading_zero)
+uart_send_repeat (char c, uint8_t count)
 {
-  uint8_t v;
+  if (count == 0)
+    return;
 
-  for (v = '0'; value >= 1000000000; value -= 1000000000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  uint8_t cursor_v = uart.cursor_v;
+  uint8_t cursor_h = uart.cursor_h + count;
+
+#ifdef UART_REPEAT
+  if (uart_csi_length(count - 1) < count - 1) {
+    uart_enqueue(c);
+    uart_send_csi(count - 1, 'b');
+  } else
+#endif
+  {
+    uart_enqueue_repeat(c, count);
+  }
 
-  for (v = '0'; value >= 100000000; value -= 100000000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  // Auto-wrap is disabled so the cursor sticks to the last column
+  uart.cursor_v = (cursor_h > UART_COLUMNS) ? UART_CURSOR_UNKNOWN : cursor_v;
+  uart.cursor_h = cursor_h;
+}
 
-  for (v = '0'; value >= 10000000; value -= 10000000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+void
+uart_send_erase (uint8_t count)
+{
+#ifdef UART_ERASE
+  if (uart_csi_length(count) < count) {
+    // The cursor position is not changed
+    uint8_t cursor_v = uart.cursor_v;
+    uint8_t cursor_h = uart.cursor_h;
 
-  for (v = '0'; value >= 1000000; value -= 1000000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+    uart_send_csi(count, 'X');
 
-  for (v = '0'; value >= 100000; value -= 100000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+    uart.cursor_v = cursor_v;
+    uart.cursor_h = cursor_h;
+    return;
+  }
+#endif
 
-  for (v = '0'; value >= 10000; value -= 10000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+  uart_send_repeat(' ', count);
+}
 
-  for (v = '0'; value >= 1000; value -= 1000, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+void
+uart_send_string (const char *buffer)
+{
+  while (*buffer != '\0')
+  {
+    // Track the cursor up to the end of the string or the longest span
+    uint8_t length = 0;
+    do
+      uart_track(buffer[length]);
+    while (buffer[++length] != '\0' && length != UART_SPAN_MAX);
+
+    uart_enqueue_span(buffer, length);
+    buffer += length;
+  }
+}
 
-  for (v = '0'; value >= 100; value -= 100, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+void
+uart_send_number (uint32_t value, uint8_t width, uart_pad_t pad)
+{
+  uint8_t text[UART_NUMBER_WIDTH];
+  uart_send_bytes(text, uart_format_number(text, value, width, pad));
+}
 
-  for (v = '0'; value >= 10; value -= 10, ++v);
-  if (leading_zero || v != '0')
-    uart_send(v);
+void
+uart_send_number_update (uint32_t value, uint32_t previous, uint8_t width,
+                         uart_pad_t pad)
+{
+  uint8_t text[UART_NUMBER_WIDTH];
+  uint8_t shown[UART_NUMBER_WIDTH];
+  uint8_t length = uart_format_number(text, value, width, pad);
+
+  // The field changed its size so all characters have to be rewritten
+  if (uart_format_number(shown, previous, width, pad) != length) {
+    uart_send_bytes(text, length);
+    return;
+  }
+
+  uint8_t first = 0;
+  while (first < length && text[first] == shown[first])
+    ++first;
+
+  if (first == length)
+    return;
+
+  uint8_t last = length;
+  while (text[last - 1] == shown[last - 1])
+    --last;
+
+  // Skip the unchanged characters with the cheaper of both motions
+  if (first < uart_csi_length(first)) {
+    uart_send_bytes(text, last);
+    return;
+  }
+
+  uint8_t cursor_v = uart.cursor_v;
+  uint8_t cursor_h = uart.cursor_h;
+  uart_send_csi(first, 'C');
+
+  // CUF is relative so it also works if the cursor position is unknown
+  uart.cursor_v = cursor_v;
+  uart.cursor_h = cursor_h + first;
 
-  uart_send('0' + value);
+  uart_send_bytes(text + first, last - first);
+}
+
+void
+uart_send_number_u8 (uint8_t value, bool_t leading_zero)
+{
+  uart_send_number(value, leading_zero ? 3 : 0, UART_PAD_ZERO);
+}
+
+void
+uart_send_number_u16 (uint16_t value, bool_t leading_zero)
+{
+  uart_send_number(value, leading_zero ? 5 : 0, UART_PAD_ZERO);
+}
+
+void
+uart_send_number_u32 (uint32_t value, bool_t leading_zero)
+{
+  uart_send_number(value, leading_zero ? 10 : 0, UART_PAD_ZERO);
 }
 
 void
 uart_send_cls (void)
 {
-  uart_send(UART_ESC);
-  uart_send_string("[J");
+  // The cursor position is not changed
+  uint8_t cursor_v = uart.cursor_v;
+  uint8_t cursor_h = uart.cursor_h;
+
+  uart_send_string("\x1B[J");
+
+  uart.cursor_v = cursor_v;
+  uart.cursor_h = cursor_h;
+
+  // The previous screen content is gone and all lines are single sized
+  uart.s_callback = 0;
+  uart.half = UART_HALF_NONE;
+
+  // Pending updates of the previous screen are dropped
+  uart.t_wakeup = UART_WAKEUP_NONE;
+  uart.t_ready = 0;
+}
+
+void
+uart_send_line_size (uart_line_size_t size)
+{
+  uint8_t cursor_v = uart.cursor_v;
+  uint8_t cursor_h = uart.cursor_h;
+
+  uint8_t sequence[3] = { UART_ESC, '#', size };
+  uart_enqueue_bytes(sequence, 3);
+
+  // Double size lines move the cursor to their last column
+  if (size != UART_LINE_SINGLE && cursor_h > (UART_COLUMNS >> 1))
+    cursor_v = UART_CURSOR_UNKNOWN;
+
+  uart.cursor_v = cursor_v;
+  uart.cursor_h = cursor_h;
+}
+
+void
+uart_set_double_height (uart_half_t half)
+{
+  uart.half = half;
 }
 
 void
 uart_send_nl (void)
 {
-  uart_send('\r');
-  uart_send('\n');
+  uart_send_string("\r\n");
 }
 
 void
 uart_send_terminal_init (void)
 {
   // Set number of columns to 80
-  uart_send(UART_ESC);
-  uart_send_string("[?3l");
+  uart_send_string("\x1B[?3l");
 
   // Reset auto-wrap mode
-  uart_send(UART_ESC);
-  uart_send_string("[?7l");
+  uart_send_string("\x1B[?7l");
 
   // Reset auto-repeat mode
-  uart_send(UART_ESC);
-  uart_send_string("[?8l");
+  uart_send_string("\x1B[?8l");
 
   // Reset interlacing mode
-  uart_send(UART_ESC);
-  uart_send_string("[?9l");
+  uart_send_string("\x1B[?9l");
 
   // Disable cursor
-  uart_send(UART_ESC);
-  uart_send_string("[?25l");
-  uart_send(UART_ESC);
-  uart_send_string("[?50l");
+  uart_send_string("\x1B[?25l");
+  uart_send_string("\x1B[?50l");
+}
+
+// --- Cursor motion ----------------------------------------------------------
+
+static __inline uint8_t
+uart_csi_length (uint8_t n)
+{
+  // ESC [ n <command>
+  return (n == 1) ? 3 : (n >= 100) ? 6 : (n >= 10) ? 5 : 4;
+}
+
+static void
+uart_send_csi (uint8_t n, char command)
+{
+  uint8_t sequence[6];
+  uint8_t length = 2;
+
+  sequence[0] = UART_ESC;
+  sequence[1] = '[';
+  if (n != 1)
+    length += uart_format_u8(sequence + length, n, 0);
+  sequence[length++] = command;
+
+  uart_send_bytes(sequence, length);
+}
+
+static uint8_t
+uart_format_u8 (uint8_t *p, uint8_t value, bool_t leading_zero)
+{
+  uint8_t length = 0;
+  uint8_t v;
+
+  for (v = '0'; value >= 100; value -= 100, ++v);
+  if (leading_zero || v != '0')
+    p[length++] = v;
+
+  for (v = '0'; value >= 10; value -= 10, ++v);
+  if (leading_zero || v != '0' || length != 0)
+    p[length++] = v;
+
+  p[length++] = '0' + value;
+  return length;
+}
+
+static uint8_t
+uart_format_number (uint8_t *p, uint32_t value, uint8_t width,
+                    uart_pad_t pad)
+{
+  // Leading zero bytes don't change the result
+  uint8_t bits = 32;
+  while (bits > 8 && (value & 0xFF000000) == 0) {
+    value <<= 8;
+    bits -= 8;
+  }
+
+  // Double dabble: bcd = 2 * bcd + bit for each bit starting at the MSB
+  uint32_t bcd_low = 0; // Lower 8 digits
+  uint16_t bcd_high = 0; // Upper 2 digits
+  for (; bits > 0; --bits) {
+    uint16_t carry = (bcd_low >= 0x50000000) ? 1 : 0;
+    bcd_high = __bcd_add_short(bcd_high, bcd_high) | carry;
+    bcd_low = __bcd_add_long(bcd_low, bcd_low) | ((value >> 31) & 0x01);
+    value <<= 1;
+  }
+
+  uint8_t digits[UART_NUMBER_WIDTH];
+  uint8_t *d = digits + UART_NUMBER_WIDTH;
+  uint16_t part = (uint16_t) bcd_low;
+  for (uint8_t i = 0; i < 4; ++i, part >>= 4)
+    *--d = '0' + (part & 0x0F);
+
+  part = (uint16_t) (bcd_low >> 16);
+  for (uint8_t i = 0; i < 4; ++i, part >>= 4)
+    *--d = '0' + (part & 0x0F);
+
+  *--d = '0' + (bcd_high & 0x0F);
+  *--d = '0' + (bcd_high >> 4);
+
+  // At least the last digit is written
+  while (d < digits + UART_NUMBER_WIDTH - 1 && *d == '0')
+    ++d;
+
+  uint8_t count = digits + UART_NUMBER_WIDTH - d;
+  if (width > UART_NUMBER_WIDTH)
+    width = UART_NUMBER_WIDTH;
+  uint8_t fill = (width > count) ? width - count : 0;
+  uint8_t length = 0;
+
+  if (pad != UART_PAD_RIGHT) {
+    uint8_t c = (pad == UART_PAD_ZERO) ? '0' : ' ';
+    for (; length < fill; ++length)
+      p[length] = c;
+  }
+
+  for (uint8_t i = 0; i < count; ++i)
+    p[length++] = d[i];
+
+  if (pad == UART_PAD_RIGHT) {
+    for (uint8_t i = 0; i < fill; ++i)
+      p[length++] = ' ';
+  }
+
+  return length;
+}
+
+static void
+uart_set_divisors (void)
+{
+  const uart_divisor_t *divisor =
+      &UART_DIVISORS[uart.rate][clock_get_profile()];
+
+  UCA0BR0 = divisor->br0;
+  UCA0BR1 = divisor->br1;
+  UCA0MCTL = divisor->mctl;
+}
+
+static uint8_t
+uart_forward_length (uint8_t v, uint8_t from, uint8_t to, uint8_t *motion)
+{
+  if (from == to) {
+    *motion = UART_MOTION_NONE;
+    return 0;
+  }
+
+  uint8_t length = uart_csi_length(to - from);
+  *motion = UART_MOTION_FORWARD;
+
+  // Overwriting is only possible if all characters in between are known
+  if (uart.s_callback == 0 || to - from >= length)
+    return length;
+
+  for (uint8_t h = from; h < to; ++h) {
+    if (uart.s_callback(v, h) == '\0')
+      return length;
+  }
+
+  *motion = UART_MOTION_OVERWRITE;
+  return to - from;
+}
+
+static void
+uart_send_forward (uint8_t v, uint8_t from, uint8_t to, uint8_t motion)
+{
+  if (motion == UART_MOTION_FORWARD) {
+    uart_send_csi(to - from, 'C');
+  } else if (motion == UART_MOTION_OVERWRITE) {
+    // Overwriting is only chosen if it is shorter than a CSI sequence
+    uint8_t characters[6];
+    uint8_t length = 0;
+
+    for (; from < to; ++from)
+      characters[length++] = uart.s_callback(v, from);
+
+    uart_send_bytes(characters, length);
+  }
+}
+
+static void
+uart_track (uint8_t c)
+{
+  if (c >= ' ' && c < 0x7F) {
+    // Auto-wrap is disabled so the cursor sticks to the last column
+    if (uart.cursor_h < UART_COLUMNS)
+      ++uart.cursor_h;
+    else
+      uart.cursor_v = UART_CURSOR_UNKNOWN;
+  } else if (c == '\r') {
+    uart.cursor_h = 1;
+  } else if (c == '\n') {
+    if (uart.cursor_v != UART_CURSOR_UNKNOWN)
+      ++uart.cursor_v;
+  } else if (c == '\b') {
+    if (uart.cursor_h > 1)
+      --uart.cursor_h;
+  } else {
+    // Escape sequences are only tracked by the methods sending them
+    uart.cursor_v = UART_CURSOR_UNKNOWN;
+  }
+}
+
+static void
+uart_enqueue (uint8_t c)
+{
+  if (ring_is_full(&uart.t_buffer))
+    uart_wait_empty();
+
+  ring_put(&uart.t_buffer, c);
+  uart_start();
+}
+
+static void
+uart_enqueue_bytes (const uint8_t *data, uint8_t length)
+{
+  for (;;)
+  {
+    uint8_t count = ring_write(&uart.t_buffer, data, length);
+    uart_start();
+
+    length -= count;
+    if (length == 0)
+      return;
+
+    data += count;
+    uart_wait_empty();
+  }
+}
+
+static void
+uart_enqueue_repeat (uint8_t c, uint8_t count)
+{
+  for (;;)
+  {
+    count -= ring_fill(&uart.t_buffer, c, count);
+    uart_start();
+
+    if (count == 0)
+      return;
+
+    uart_wait_empty();
+  }
+}
+
+static void
+uart_wait_empty (void)
+{
+  // Enable reentrant interrupts and wait until buffer is empty
+  uart.t_wait = UART_SEND_WAITING;
+
+  while (uart.t_wait == UART_SEND_WAITING)
+    __bis_SR_register(GIE + CPUOFF);
+}
+
+static void
+uart_send_control (uint8_t c)
+{
+  uart.t_control = c;
+
+  // The transmit buffer register is empty if the interrupt is stopped
+  if (uart.t_idle || uart.t_pause == UART_PAUSE_STOPPED) {
+    uart.t_idle = 0;
+    IFG2 |= UCA0TXIFG;
+  }
+}
+
+static __inline void
+uart_start (void)
+{
+  // The receive interrupt restarts the transmission for flow control
+  // characters as well
+  unsigned short state = __get_interrupt_state();
+  __disable_interrupt();
+
+  if (uart.t_idle) {
+    // Restart the transmit interrupt which sends the queued characters
+    uart.t_idle = 0;
+    IFG2 |= UCA0TXIFG;
+  }
+
+  __set_interrupt_state(state);
+}
+
+static void
+uart_enqueue_span (const char *data, uint8_t length)
+{
+  uint8_t head = uart.s_head;
+
+  if (length < UART_SPAN_MIN
+      || (uint8_t) (head - uart.s_tail) >= UART_SPAN_COUNT)
+  {
+    // Copying is cheaper or all descriptors are in use
+    uart_enqueue_bytes((const uint8_t*) data, length);
+    return;
+  }
+
+  // Publish the descriptor before the marker which references it
+  head &= UART_SPAN_COUNT - 1;
+  uart.s_data[head] = data;
+  uart.s_length[head] = length;
+  ++uart.s_head;
+
+  uart_enqueue(UART_SPAN_MARKER);
 }
 
 #pragma vector=USCIAB0TX_VECTOR
@@ -232,21 +828,56 @@ __interrupt void
 uart_int_tx (void)
 {
   // Check for more data to transmit
-  if (!buffer_is_empty(&uart.t_buffer)) {
-    // Send next character (The interrupt flag is automatically cleared)
-    UCA0TXBUF = buffer_dequeue(&uart.t_buffer);
+  // (Writing the next character automatically clears the interrupt flag)
+  if (uart.t_control != UART_CONTROL_NONE) {
+    // Flow control characters overtake the queued data
+    UCA0TXBUF = uart.t_control;
+    uart.t_control = UART_CONTROL_NONE;
     return;
+  } else if (uart.t_pause != UART_PAUSE_NONE) {
+    // Wait for XON, the receive interrupt restarts the transmission
+    IFG2 &= ~UCA0TXIFG;
+    uart.t_pause = UART_PAUSE_STOPPED;
+    return;
+  } else if (uart.t_span_length != 0) {
+    // Continue sending the span directly from its source
+    --uart.t_span_length;
+    UCA0TXBUF = *uart.t_span++;
+  } else if (!ring_is_empty(&uart.t_buffer)) {
+    uint8_t c = ring_get(&uart.t_buffer);
+
+    if (c == UART_SPAN_MARKER) {
+      // Start sending the next span
+      uint8_t tail = uart.s_tail & (UART_SPAN_COUNT - 1);
+      uart.t_span = (const uint8_t*) uart.s_data[tail];
+      uart.t_span_length = uart.s_length[tail] - 1;
+      ++uart.s_tail;
+
+      c = *uart.t_span++;
+    }
+
+    UCA0TXBUF = c;
+  } else {
+    // Clear interrupt flag, uart_send restarts the transmission
+    IFG2 &= ~UCA0TXIFG;
+    uart.t_idle = 0x01;
+
+    if (uart.t_wait) {
+      // CPU is waiting to get activated => activate
+      uart.t_wait = UART_SEND_NOT_WAITING;
+
+      // Enable CPU on interrupt exit
+      __bic_SR_register_on_exit(CPUOFF + GIE);
+      return;
+    }
   }
 
-  // Clear interrupt flag
-  IFG2 &= ~UCA0TXIFG;
-
-  if (uart.t_wait) {
-    // CPU is waiting to get activated => activate
-    uart.t_wait = UART_SEND_NOT_WAITING;
+  if (ring_get_fill(&uart.t_buffer) < uart.t_wakeup) {
+    // Enough space for the next part of the update => activate
+    uart.t_wakeup = UART_WAKEUP_NONE;
+    uart.t_ready = 0x01;
 
-    // Enable CPU on interrupt exit
-    __bic_SR_register_on_exit(CPUOFF + GIE);
+    __bic_SR_register_on_exit(CPUOFF);
   }
 }
 
@@ -254,16 +885,63 @@ uart_int_tx (void)
 __interrupt void
 uart_int_rx (void)
 {
+#ifdef UART_AUTO_BAUD
+  if (UCA0STAT & UCBRK) {
+    // The USCI took over the baud rate measured in the synch field, drop the
+    // break character and the garbage received before
+    (void) UCA0RXBUF;
+    UCA0ABCTL &= ~(UCSTOE | UCBTOE);
+    keys_init();
+    return;
+  }
+#endif
+
+  // A character was overwritten before it was read
+  if (UCA0STAT & UCOE)
+    ++uart.r_dropped;
+
   // Read character (The interrupt flag is automatically cleared)
-  uint8_t received_char = UCA0RXBUF;
+  uint8_t c = UCA0RXBUF;
+
+#ifdef UART_FLOW_CONTROL
+  if (c == UART_XOFF) {
+    if (uart.t_pause == UART_PAUSE_NONE)
+      uart.t_pause = UART_PAUSE_REQUESTED;
+    return;
+  }
 
-  if (buffer_is_full(&uart.r_buffer)) {
-    // An buffer overflow occurred -> Discard all old data
-    buffer_clear(&uart.r_buffer);
+  if (c == UART_XON) {
+    // Restart the transmission if the transmit interrupt stopped for XOFF
+    if (uart.t_pause == UART_PAUSE_STOPPED)
+      IFG2 |= UCA0TXIFG;
+
+    uart.t_pause = UART_PAUSE_NONE;
+    return;
+  }
+#endif
+
+  keycode_t key = keys_decode(c);
+  if (key == KEY_NONE)
+    return; // Escape sequence not complete yet
+
+  // The old data belongs to the consumer -> Discard the new key
+  // if the buffer overflows
+  if (ring_is_full(&uart.r_buffer))
+    ++uart.r_dropped;
+  else
+    ring_put(&uart.r_buffer, key);
+
+#ifdef UART_FLOW_CONTROL
+  if (!uart.r_stopped && ring_get_fill(&uart.r_buffer) >= UART_R_HIGH) {
+    // Stop the host before the buffer overflows
+    uart.r_stopped = 0x01;
+    uart_send_control(UART_XOFF);
   }
+#endif
 
-  buffer_enqueue(&uart.r_buffer, received_char);
+  // The data is passed to the callback by uart_process
+  uart.r_ready = 0x01;
 
-  if (uart.r_callback != 0 && uart.r_callback(&uart.r_buffer))
+  if (uart.r_callback != 0)
     __bic_SR_register_on_exit(CPUOFF);
 }
@@ -6,7 +6,7 @@
 
 #include <stdint.h>
 
-#include "inc/buffer.h"
+#include "inc/ring.h"
 #include "inc/uart.h"
 
 // ----------------------------------------------------------------------------
@@ -16,54 +16,373 @@
 #define UART_SEND_WAITING 0x01
 #define UART_SEND_NOT_WAITING 0x00
 
+#if !RING_IS_VALID_SIZE(UART_R_BUFFER_SIZE) \
+    || !RING_IS_VALID_SIZE(UART_T_BUFFER_SIZE)
+#error "The UART buffer sizes have to be powers of two up to 128"
+#endif
+
+// A span of constant data is queued as a single marker character
+#define UART_SPAN_MARKER 0x00
+#define UART_SPAN_COUNT 2 // Power of two
+#define UART_SPAN_MIN 4 // Shorter spans are copied
+#define UART_SPAN_MAX 0xFF
+
+// Value of t_wakeup without a pending wake up request
+#define UART_WAKEUP_NONE 0x00
+
 #define UART_ESC 0x1B
 
-// See documentation page 424
-#ifdef UART_1MHZ
-#ifdef UART_115K
-#define UART_PRESCALER 8
-#define UART_MODULATION 6
-#endif
+// Software flow control
+#define UART_XON 0x11
+#define UART_XOFF 0x13
+#define UART_CONTROL_NONE 0x00
 
-#ifdef UART_38K
-#define UART_PRESCALER 26
-#define UART_MODULATION 0
-#endif
+// States of the transmission after the host sent XOFF
+#define UART_PAUSE_NONE 0x00
+#define UART_PAUSE_REQUESTED 0x01 // XOFF received
+#define UART_PAUSE_STOPPED 0x02 // The transmit interrupt stopped
 
-#ifdef UART_9K
-#define UART_PRESCALER 104
-#define UART_MODULATION 1
-#endif
-#endif
+// Fill of the receive buffer to send XOFF and XON
+#define UART_R_HIGH (UART_R_BUFFER_SIZE - (UART_R_BUFFER_SIZE >> 2))
+#define UART_R_LOW (UART_R_BUFFER_SIZE >> 2)
 
-#ifdef UART_1048KHZ
-#ifdef UART_115K
-#define UART_PRESCALER 9
-#define UART_MODULATION 1
-#endif
+// Number of columns set up by uart_send_terminal_init
+#define UART_COLUMNS 80
 
-#ifdef UART_38K
-#define UART_PRESCALER 27
-#define UART_MODULATION 2
-#endif
+// Row value of a cursor with an unknown position
+#define UART_CURSOR_UNKNOWN 0x00
+
+// Horizontal cursor motions
+#define UART_MOTION_NONE 0x00
+#define UART_MOTION_FORWARD 0x01 // CUF
+#define UART_MOTION_OVERWRITE 0x02 // Re-send the known characters
+#define UART_MOTION_BACKSPACE 0x03 // BS characters
+#define UART_MOTION_BACKWARD 0x04 // CUB
+#define UART_MOTION_RETURN 0x05 // CR followed by a forward motion
+
+/*
+ * Baud rate generation for the SMCLK frequency f (Hz) and the baud rate b:
+ * The 16x oversampling mode is used as soon as the prescaler N = f / b
+ * reaches 16 (UCBRx = INT(N / 16), UCBRFx = FRAC(N / 16) * 16). Every bit
+ * then lasts the rounded N clocks and the error grows up to the stop bit.
+ * Below, the low-frequency mode divides by UCBRx = INT(N) and stretches
+ * single bits of a character by one clock following the UCBRSx pattern
+ * (SLAU144 table 15-2). UCBRSx is chosen for the smallest worst error of a
+ * bit edge within the 10 bits of a character. It only depends on FRAC(N)
+ * and changes at the fractions below.
+ */
+#define UART_OVERSAMPLING(f, b) ((f) / (b) >= 16)
+#define UART_N(f, b) (((f) + (b) / 2) / (b))
+#define UART_FRAC(f, b) ((f) % (b)) // FRAC(N) * b
+
+#define UART_BRS(f, b) ( \
+    (10 * UART_FRAC(f, b) > 1 * (b)) + (19 * UART_FRAC(f, b) > 4 * (b)) \
+    + (3 * UART_FRAC(f, b) > 1 * (b)) + (19 * UART_FRAC(f, b) > 8 * (b)) \
+    + (13 * UART_FRAC(f, b) > 7 * (b)) + (17 * UART_FRAC(f, b) > 11 * (b)) \
+    + (17 * UART_FRAC(f, b) > 13 * (b)))
+
+#define UART_BR(f, b) (UART_OVERSAMPLING(f, b) \
+    ? UART_N(f, b) >> 4 : (f) / (b))
+#define UART_MCTL(f, b) (UART_OVERSAMPLING(f, b) \
+    ? ((UART_N(f, b) & 0x0F) << 4) | UCOS16 \
+    : UART_BRS(f, b) << 1)
+
+// Stretched bits within the first n bits, one nibble per UCBRSx value.
+// The pattern repeats after 8 bits.
+#define UART_MOD_SUM_1 0x00000000UL
+#define UART_MOD_SUM_2 0x11111110UL
+#define UART_MOD_SUM_3 0x22211110UL
+#define UART_MOD_SUM_4 0x33322110UL
+#define UART_MOD_SUM_5 0x43322110UL
+#define UART_MOD_SUM_6 0x54433210UL
+#define UART_MOD_SUM_7 0x65433210UL
+#define UART_MOD_SUM_8 0x76543210UL
+#define UART_MOD_SUM(f, b, n) \
+    ((UART_MOD_SUM_##n >> (UART_BRS(f, b) << 2)) & 0x0F)
 
-#ifdef UART_9K
-#define UART_PRESCALER 109
-#define UART_MODULATION 2
+#define UART_DIFF(x, y) ((x) > (y) ? (x) - (y) : (y) - (x))
+
+// Error of the edge after n bits with m stretched bits (In 0.1 % of a bit)
+#define UART_BIT_ERROR(f, b, n, m) \
+    (UART_DIFF((m) * (b), (n) * UART_FRAC(f, b)) / ((f) / 1000))
+#define UART_BIT_VALID(f, b, n) \
+    (UART_BIT_ERROR(f, b, n, UART_MOD_SUM(f, b, n)) <= UART_BAUD_ERROR_MAX)
+
+#define UART_LOW_FREQUENCY_VALID(f, b) ( \
+    UART_BIT_VALID(f, b, 1) && UART_BIT_VALID(f, b, 2) \
+    && UART_BIT_VALID(f, b, 3) && UART_BIT_VALID(f, b, 4) \
+    && UART_BIT_VALID(f, b, 5) && UART_BIT_VALID(f, b, 6) \
+    && UART_BIT_VALID(f, b, 7) && UART_BIT_VALID(f, b, 8) \
+    && UART_BIT_ERROR(f, b, 9, UART_MOD_SUM(f, b, 8)) \
+        <= UART_BAUD_ERROR_MAX \
+    && UART_BIT_ERROR(f, b, 10, \
+        UART_MOD_SUM(f, b, 8) + UART_MOD_SUM(f, b, 2)) \
+        <= UART_BAUD_ERROR_MAX)
+
+// Error of the stop bit edge (In 0.1 % of a bit)
+#define UART_OVERSAMPLING_ERROR(f, b) \
+    (UART_DIFF(UART_N(f, b) * (b), (f)) * 10 / ((f) / 1000))
+
+#define UART_IS_VALID(f, b) (UART_BR(f, b) != 0 \
+    && (UART_OVERSAMPLING(f, b) \
+        ? UART_OVERSAMPLING_ERROR(f, b) <= UART_BAUD_ERROR_MAX \
+        : UART_LOW_FREQUENCY_VALID(f, b)))
+
+#define UART_DIVISOR(f, b) { \
+    (uint8_t) UART_BR(f, b), (uint8_t) (UART_BR(f, b) >> 8), \
+    (uint8_t) UART_MCTL(f, b), UART_IS_VALID(f, b) }
+
+#if !UART_IS_VALID(F_SMCLK, UART_BAUD)
+#error "The baud rate can't be generated from F_SMCLK within the error bound"
 #endif
+
+// clock_init falls back to CLOCK_1MHZ if the profile isn't calibrated
+#if !UART_IS_VALID(CLOCK_1MHZ_FREQUENCY, UART_BAUD)
+#error "The baud rate can't be generated with the fallback clock CLOCK_1MHZ"
 #endif
 
+// Baud rates selected with uart_set_fast
+#define UART_RATE_DEFAULT 0x00 // UART_BAUD
+#define UART_RATE_FAST 0x01 // UART_BAUD_FAST
+#define UART_RATE_COUNT 2
+
 // ----------------------------------------------------------------------------
 // Types
 // ----------------------------------------------------------------------------
 
+/**
+ * Register values of the baud rate generator.
+ */
 typedef struct {
-  buffer_t r_buffer;
-  buffer_t t_buffer;
+  uint8_t br0;
+  uint8_t br1;
+  uint8_t mctl;
+  bool_t valid;
+} uart_divisor_t;
+
+typedef struct {
+  ring_t r_buffer;
+  ring_t t_buffer;
+
+  // Constant data referenced by markers in the transmit buffer which is sent
+  // without copying (Indices like ring_t, separate arrays avoid padding)
+  const char *s_data[UART_SPAN_COUNT];
+  uint8_t s_length[UART_SPAN_COUNT];
+  volatile uint8_t s_head;
+  volatile uint8_t s_tail;
+
+  // Remaining part of the span which is currently sent
+  const uint8_t *t_span;
+  uint8_t t_span_length;
+
+  // Data was received which wasn't passed to the callback yet
+  volatile bool_t r_ready;
+
+  // Received bytes which were lost because the buffer was full
+  volatile uint16_t r_dropped;
+
+  // XOFF was sent to the host (UART_FLOW_CONTROL)
+  volatile bool_t r_stopped;
 
-  bool_t t_wait;
+  // The host sent XOFF (UART_PAUSE_*, UART_FLOW_CONTROL)
+  volatile uint8_t t_pause;
 
-  bool_t (*r_callback)(buffer_t *buffer);
+  // Flow control character which is sent before the queued data
+  volatile uint8_t t_control;
+
+  volatile bool_t t_wait;
+
+  // The transmit interrupt stopped after sending the last character
+  volatile bool_t t_idle;
+
+  // Wake up the CPU as soon as the transmit buffer holds less bytes
+  volatile uint8_t t_wakeup;
+  volatile bool_t t_ready;
+
+  // Terminal cursor position (1-based) or UART_CURSOR_UNKNOWN
+  uint8_t cursor_v;
+  uint8_t cursor_h;
+
+  // Addressed half of double-height lines (uart_half_t)
+  uint8_t half;
+
+  // Selected baud rate (UART_RATE_DEFAULT or UART_RATE_FAST)
+  uint8_t rate;
+
+  bool_t (*r_callback)(ring_t *buffer);
+  char (*s_callback)(uint8_t v, uint8_t h);
 } uart_t;
 
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+
+// Baud rate generator settings for each baud rate and clock profile
+static const uart_divisor_t
+UART_DIVISORS[UART_RATE_COUNT][CLOCK_PROFILE_COUNT] = {
+  {
+    UART_DIVISOR(CLOCK_1MHZ_FREQUENCY, UART_BAUD),
+    UART_DIVISOR(CLOCK_8MHZ_FREQUENCY, UART_BAUD),
+    UART_DIVISOR(CLOCK_16MHZ_FREQUENCY, UART_BAUD)
+  },
+  {
+    UART_DIVISOR(CLOCK_1MHZ_FREQUENCY, UART_BAUD_FAST),
+    UART_DIVISOR(CLOCK_8MHZ_FREQUENCY, UART_BAUD_FAST),
+    UART_DIVISOR(CLOCK_16MHZ_FREQUENCY, UART_BAUD_FAST)
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Methods
+// ----------------------------------------------------------------------------
+
+/**
+ * Returns the number of bytes of a CSI sequence with a single parameter.
+ * The parameter is omitted if it equals the default value 1.
+ *
+ * @param n The parameter of the sequence
+ * @return The number of bytes of the sequence
+ */
+static __inline uint8_t
+uart_csi_length (uint8_t n);
+
+/**
+ * Sends a CSI sequence with a single parameter.
+ * The parameter is omitted if it equals the default value 1.
+ *
+ * @param n The parameter of the sequence
+ * @param command The final character of the sequence
+ */
+static void
+uart_send_csi (uint8_t n, char command);
+
+/**
+ * Sets the prescaler and the modulation for the selected baud rate and the
+ * current clock profile.
+ * The USCI has to be in reset state.
+ */
+static void
+uart_set_divisors (void);
+
+/**
+ * Computes the cheapest motion to move the cursor forward in the row v.
+ * Known characters are re-sent if this is cheaper than a CUF sequence.
+ *
+ * @param v The current row of the cursor
+ * @param from The current column of the cursor
+ * @param to The column to move to
+ * @param motion Receives the selected motion
+ * @return The number of bytes of the motion
+ */
+static uint8_t
+uart_forward_length (uint8_t v, uint8_t from, uint8_t to, uint8_t *motion);
+
+/**
+ * Moves the cursor forward in the row v with the specified motion.
+ *
+ * @param v The current row of the cursor
+ * @param from The current column of the cursor
+ * @param to The column to move to
+ * @param motion The motion to use
+ */
+static void
+uart_send_forward (uint8_t v, uint8_t from, uint8_t to, uint8_t motion);
+
+/**
+ * Writes the 8-bit value as ASCII text to the memory.
+ *
+ * @param p The memory to write to (At least 3 bytes)
+ * @param value The value to write
+ * @param leading_zero If leading '0's should be written
+ * @return The number of characters written
+ */
+static uint8_t
+uart_format_u8 (uint8_t *p, uint8_t value, bool_t leading_zero);
+
+/**
+ * Writes the value as ASCII text padded to the field width to the memory.
+ * The binary value is converted to BCD by shifting it in bit by bit with the
+ * decimal addition of the CPU, so no division is required.
+ *
+ * @param p The memory to write to (At least UART_NUMBER_WIDTH bytes)
+ * @param value The value to write
+ * @param width The width of the field (Up to UART_NUMBER_WIDTH)
+ * @param pad The padding of the field
+ * @return The number of characters written
+ */
+static uint8_t
+uart_format_number (uint8_t *p, uint32_t value, uint8_t width,
+                    uart_pad_t pad);
+
+/**
+ * Updates the tracked cursor position for the character sent.
+ *
+ * @param c The character which is sent
+ */
+static void
+uart_track (uint8_t c);
+
+/**
+ * Puts the character into the transmit buffer and starts the transmission.
+ * Waits in low power mode if the buffer is full.
+ *
+ * @param c The character to queue
+ */
+static void
+uart_enqueue (uint8_t c);
+
+/**
+ * Copies the data into the transmit buffer and starts the transmission.
+ * As much data as fits is copied at once. Waits in low power mode only if
+ * the buffer is full.
+ *
+ * @param data The data to queue
+ * @param length The number of bytes to queue
+ */
+static void
+uart_enqueue_bytes (const uint8_t *data, uint8_t length);
+
+/**
+ * Puts the character count times into the transmit buffer like
+ * uart_enqueue_bytes.
+ *
+ * @param c The character to queue
+ * @param count The number of times to queue the character
+ */
+static void
+uart_enqueue_repeat (uint8_t c, uint8_t count);
+
+/**
+ * Waits in low power mode until the transmit buffer is empty.
+ */
+static void
+uart_wait_empty (void);
+
+/**
+ * Sends the flow control character before the queued data.
+ * Must be called with disabled interrupts.
+ *
+ * @param c XON or XOFF
+ */
+static void
+uart_send_control (uint8_t c);
+
+/**
+ * Restarts the transmit interrupt if it stopped after the last character.
+ * Interrupts are disabled meanwhile, the receive interrupt restarts it for
+ * flow control characters as well.
+ */
+static __inline void
+uart_start (void);
+
+/**
+ * Queues the data as span which is read by the transmit interrupt.
+ * Short spans are copied into the transmit buffer instead.
+ *
+ * @param data The data which must not change until it was sent
+ * @param length The number of bytes to send (At least 1)
+ */
+static void
+uart_enqueue_span (const char *data, uint8_t length);
+
 #endif // !__UART_P_H